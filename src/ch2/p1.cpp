@@ -1,31 +1,80 @@
 #include "List.hpp"
+#include "Hashing.hpp"
 #include "testing.hpp"
+#include "benchmark.hpp"
+#include "allocation.hpp"
+#include "parallel.hpp"
 
 #include <unordered_set>
+#include <vector>
+#include <random>
+#include <algorithm>
+#include <string>
+#include <iostream>
 
 /**
  * @brief Remove Dups.
  *
  * Remove duplicate elements in an unsorted linked list.
+ * The set of seen values is pluggable (anything with std::unordered_set-like reserve/insert),
+ * and a single insert() both checks and records each value.
  * Time complexity: O(N).
  * Space complexity: O(N) (or number of unique values to be precise).
+ *
+ * @param size_hint expected number of unique values (e.g. list length), used to pre-size the set
  */
-template <typename T>
-void remove_duplicates(FwdList<T> & l)
+template <typename T, typename Set = std::unordered_set<T>>
+void remove_duplicates(FwdList<T> & l, size_t size_hint = 0)
 {
   using Node = typename FwdList<T>::Node;
-  std::unordered_set<T> seen;
+  Set seen;
+  seen.reserve(size_hint);
   for (Node * curr = l.head, * prev = nullptr; curr; prev = curr, curr = curr->next)
   {
-    if (seen.count(curr->val) > 0)
+    if (!seen.insert(curr->val).second)
     {
       prev->next = curr->next;
       delete curr;
       curr = prev;
     }
-    else
+  }
+}
+
+/**
+ * @brief Remove Dups.
+ *
+ * Same as above, but a Bloom filter is used as a prefilter for huge lists with few duplicates.
+ * The first pass feeds every value into the filter and collects those the filter claims
+ * to have seen before: this includes every true duplicate plus a few false positives.
+ * The second pass only needs an exact set for those candidates; all other values are unique.
+ * Time complexity: O(N).
+ * Space complexity: O(N) bits for the filter plus O(D) for D candidate values.
+ */
+template <typename T>
+void remove_duplicates_bloom(FwdList<T> & l)
+{
+  using Node = typename FwdList<T>::Node;
+
+  size_t len = 0;
+  for (auto n = l.head; n; n = n->next) ++len;
+
+  FlatHashSet<T> candidates;
+  {
+    BloomFilter<T> filter(len);
+    for (auto n = l.head; n; n = n->next)
+    {
+      if (filter.insert(n->val)) candidates.insert(n->val);
+    }
+  }
+
+  FlatHashSet<T> seen(candidates.size());
+  for (Node * curr = l.head, * prev = nullptr; curr; prev = curr, curr = curr->next)
+  {
+    if (candidates.contains(curr->val) && !seen.insert(curr->val).second)
     {
-      seen.insert(curr->val);
+      prev->next = curr->next;
+      delete curr;
+      curr = prev;
     }
   }
 }
@@ -54,6 +103,97 @@ void remove_duplicates_v2(FwdList<T> & l)
   }
 }
 
+/**
+ * @brief Remove Dups.
+ *
+ * Sort-based version for very long lists, optionally parallel.
+ * Node pointers are gathered into an array together with their positions and sorted
+ * by (value, position), so each run of equal values starts with its first occurrence.
+ * All other members of each run are marked, then the list is relinked in one pass,
+ * which keeps the original order of survivors.
+ * Chunks are sorted on separate threads and then merged pairwise, also in parallel.
+ * Requires T to be less-than comparable.
+ * Time complexity: O(N log N); with P threads O((N/P) log N + N), since gathering the nodes,
+ * the final merge and relinking each take a serial O(N) pass.
+ * Space complexity: O(N), specifically N * (2 words + 1 byte) for the entries and marks,
+ * plus std::inplace_merge's temporary buffer of up to N/2 entries (N words) when P > 1.
+ */
+template <typename T>
+void remove_duplicates_sort(FwdList<T> & l, unsigned num_threads = parallel::default_threads())
+{
+  using Node = typename FwdList<T>::Node;
+  using Entry = std::pair<Node *, size_t>;
+
+  size_t len = 0;
+  for (Node * n = l.head; n; n = n->next) ++len;
+  if (len < 2) return;
+
+  std::vector<Entry> entries;
+  entries.reserve(len);
+  for (Node * n = l.head; n; n = n->next) entries.emplace_back(n, entries.size());
+
+  auto const less = [](Entry const & a, Entry const & b)
+  {
+    if (a.first->val < b.first->val) return true;
+    if (b.first->val < a.first->val) return false;
+    return a.second < b.second;
+  };
+
+  // sort chunks independently, remembering chunk boundaries
+  num_threads = static_cast<unsigned>(std::max<size_t>(1, std::min<size_t>(num_threads, len)));
+  std::vector<size_t> bounds(num_threads + 1, len);
+  parallel::for_chunks(len, num_threads, [&](unsigned t, size_t b, size_t e)
+  {
+    bounds[t] = b;
+    std::sort(entries.begin() + b, entries.begin() + e, less);
+  });
+
+  // merge adjacent sorted chunks pairwise until a single one remains
+  for (size_t width = 1; width < num_threads; width *= 2)
+  {
+    size_t const num_merges = (num_threads + 2 * width - 1) / (2 * width);
+    parallel::for_chunks(num_merges, static_cast<unsigned>(num_merges), [&](unsigned, size_t b, size_t e)
+    {
+      for (size_t m = b; m < e; ++m)
+      {
+        size_t const first = 2 * width * m;
+        size_t const mid = std::min<size_t>(first + width, num_threads);
+        size_t const last = std::min<size_t>(first + 2 * width, num_threads);
+        std::inplace_merge(entries.begin() + bounds[first],
+                           entries.begin() + bounds[mid],
+                           entries.begin() + bounds[last], less);
+      }
+    });
+  }
+
+  // mark every element equal to its predecessor in sorted order
+  std::vector<char> dup(len, 0);
+  parallel::for_chunks(len, num_threads, [&](unsigned, size_t b, size_t e)
+  {
+    for (size_t i = std::max<size_t>(b, 1); i < e; ++i)
+    {
+      if (entries[i - 1].first->val == entries[i].first->val) dup[entries[i].second] = 1;
+    }
+  });
+
+  // relink in original order
+  size_t pos = 1;
+  for (Node * curr = l.head->next, * prev = l.head; curr; ++pos)
+  {
+    Node * const next = curr->next;
+    if (dup[pos])
+    {
+      prev->next = next;
+      delete curr;
+    }
+    else
+    {
+      prev = curr;
+    }
+    curr = next;
+  }
+}
+
 template <typename F>
 void test_solution(FwdList<int> l, FwdList<int> const & e, F f)
 {
@@ -63,11 +203,69 @@ void test_solution(FwdList<int> l, FwdList<int> const & e, F f)
 
 void test(FwdList<int> const & l, FwdList<int> const & e)
 {
-  test_solution(l, e, remove_duplicates<int>);
+  test_solution(l, e, [](auto & l){ remove_duplicates<int>(l); });
+  test_solution(l, e, [](auto & l){ remove_duplicates<int, FlatHashSet<int>>(l); });
+  test_solution(l, e, [](auto & l){ remove_duplicates<int, FlatHashSet<int>>(l, 100); });
+  test_solution(l, e, remove_duplicates_bloom<int>);
+  test_solution(l, e, [](auto & l){ remove_duplicates_sort<int>(l, 1); });
+  test_solution(l, e, [](auto & l){ remove_duplicates_sort<int>(l, 3); });
+  test_solution(l, e, [](auto & l){ remove_duplicates_sort<int>(l, 8); });
   test_solution(l, e, remove_duplicates_v2<int>);
 }
 
-int main()
+/**
+ * Make a list of @p n values where roughly a @p dup_ratio fraction are repeats of earlier values.
+ */
+FwdList<int> make_input(size_t n, double dup_ratio)
+{
+  std::mt19937 gen(42);
+  size_t const num_unique = std::max<size_t>(1, n - size_t(n * dup_ratio));
+  std::vector<int> vals(n);
+  for (size_t i = 0; i < num_unique; ++i) vals[i] = int(gen());
+  std::uniform_int_distribution<size_t> pick(0, num_unique - 1);
+  for (size_t i = num_unique; i < n; ++i) vals[i] = vals[pick(gen)];
+  std::shuffle(vals.begin(), vals.end(), gen);
+
+  FwdList<int> l;
+  for (auto it = vals.rbegin(); it != vals.rend(); ++it)
+  {
+    l.head = new FwdList<int>::Node{ l.head, *it };
+  }
+  return l;
+}
+
+void test_large(size_t n, double dup_ratio)
+{
+  FwdList<int> e = make_input(n, dup_ratio);
+  remove_duplicates_v2(e);
+  test(make_input(n, dup_ratio), e);
+}
+
+void bench()
+{
+  size_t const n = 1'000'000;
+  for (double const ratio : { 0.0, 0.01, 0.1, 0.5, 0.9, 0.99 })
+  {
+    FwdList<int> const input = make_input(n, ratio);
+    auto const run = [&](std::string const & name, auto f)
+    {
+      double const t = benchmark::measure([&]{ return FwdList<int>(input); }, f, 3);
+      benchmark::report(name + " dups=" + std::to_string(int(ratio * 100)) + "%", n, t);
+      FwdList<int> l(input);
+      size_t const bytes = allocation::peak_usage([&]{ f(l); });
+      std::cout << "    extra memory: " << bytes / 1024 << " KiB\n";
+    };
+    run("unordered_set", [](auto & l){ remove_duplicates<int>(l); });
+    run("unordered_set+reserve", [](auto & l){ remove_duplicates<int>(l, n); });
+    run("FlatHashSet", [](auto & l){ remove_duplicates<int, FlatHashSet<int>>(l); });
+    run("FlatHashSet+reserve", [](auto & l){ remove_duplicates<int, FlatHashSet<int>>(l, n); });
+    run("bloom+FlatHashSet", [](auto & l){ remove_duplicates_bloom<int>(l); });
+    run("sort", [](auto & l){ remove_duplicates_sort<int>(l, 1); });
+    run("sort parallel", [](auto & l){ remove_duplicates_sort<int>(l); });
+  }
+}
+
+int main(int argc, char ** argv)
 {
   test({}, {});
   test({1}, {1});
@@ -75,5 +273,10 @@ int main()
   test({1,2,3}, {1,2,3});
   test({1,1,2,3}, {1,2,3});
   test({5,2,4,2,1,5,3}, {5,2,4,1,3});
+  test({3,3,3,2,2,1}, {3,2,1});
+  test_large(3000, 0.0);
+  test_large(3000, 0.5);
+  test_large(3000, 0.99);
+  if (benchmark::requested(argc, argv)) bench();
   return testing::summary();
 }
@@ -1,7 +1,13 @@
 #include "List.hpp"
+#include "UnrolledList.hpp"
 #include "testing.hpp"
+#include "benchmark.hpp"
 
 #include <cassert>
+#include <vector>
+#include <random>
+#include <numeric>
+#include <cmath>
 
 /**
  * @brief N-th to Last.
@@ -24,7 +30,368 @@ T nth_to_last(FwdList<T> const & l, size_t n)
   return tail->val;
 }
 
-int main()
+/**
+ * @brief N-th to Last.
+ *
+ * Same for an unrolled list: walk whole nodes back from the tail, then index into one.
+ * Time complexity: O(n/K).
+ * Space complexity: O(1).
+ */
+template <typename T, size_t K>
+T nth_to_last(UnrolledList<T, K> const & l, size_t n)
+{
+  assert(n < l.size());
+  auto node = l.tail;
+  for (; n >= node->count; n -= node->count, node = node->prev);
+  return node->vals[node->count - 1 - n];
+}
+
+/**
+ * @brief Positional index over a singly-linked list.
+ *
+ * Splits the list into blocks of consecutive nodes, remembering the first node and
+ * length of each block, with a Fenwick tree over block lengths to find the block
+ * holding a given position. Lookups then walk at most one block.
+ * Insertions/removals made through the index keep it up to date incrementally:
+ * they adjust one block length and only split a block that grew to twice the target
+ * size, or drop a block that became empty (which rebuilds the Fenwick tree in O(N/K)).
+ * Modifying the list bypassing the index requires rebuild().
+ *
+ * Lookup: O(log(N/K) + K). Update: O(log(N/K) + K), amortized.
+ * With the default K = sqrt(N) both are O(sqrt(N)), and repeated queries no longer scan the list.
+ */
+template <typename T>
+class FwdListIndex
+{
+public:
+
+  using Node = typename FwdList<T>::Node;
+
+  /**
+   * @param block_size target number of nodes per block, 0 to pick sqrt(N)
+   */
+  explicit FwdListIndex(FwdList<T> & l, size_t block_size = 0)
+  : m_list(l), m_requested_block(block_size)
+  {
+    rebuild();
+  }
+
+  void rebuild()
+  {
+    m_size = 0;
+    for (auto n = m_list.head; n; n = n->next) ++m_size;
+    m_block = m_requested_block > 0 ? m_requested_block : std::max<size_t>(8, size_t(std::sqrt(double(m_size))));
+
+    m_first.clear();
+    m_count.clear();
+    size_t k = 0;
+    for (auto n = m_list.head; n; n = n->next, ++k)
+    {
+      if (k % m_block == 0)
+      {
+        m_first.push_back(n);
+        m_count.push_back(0);
+      }
+      ++m_count.back();
+    }
+    rebuild_tree();
+  }
+
+  [[nodiscard]]
+  size_t size() const
+  {
+    return m_size;
+  }
+
+  [[nodiscard]]
+  Node * at(size_t i) const
+  {
+    assert(i < m_size);
+    auto [b, offset] = locate(i);
+    Node * n = m_first[b];
+    for (; offset > 0; --offset) n = n->next;
+    return n;
+  }
+
+  [[nodiscard]]
+  T const & nth(size_t i) const
+  {
+    return at(i)->val;
+  }
+
+  [[nodiscard]]
+  T const & nth_to_last(size_t n) const
+  {
+    assert(n < m_size);
+    return at(m_size - 1 - n)->val;
+  }
+
+  void push_front(T val)
+  {
+    m_list.head = new Node{ m_list.head, std::move(val) };
+    if (m_first.empty())
+    {
+      m_first.push_back(m_list.head);
+      m_count.push_back(0);
+      rebuild_tree();
+    }
+    m_first[0] = m_list.head;
+    grow(0);
+  }
+
+  /**
+   * @brief Insert a new node after position @p i, so that it becomes position i + 1.
+   */
+  void insert_after(size_t i, T val)
+  {
+    assert(i < m_size);
+    auto [b, offset] = locate(i);
+    Node * prev = m_first[b];
+    for (; offset > 0; --offset) prev = prev->next;
+    prev->next = new Node{ prev->next, std::move(val) };
+    grow(b);
+  }
+
+  void pop_front()
+  {
+    assert(m_list.head);
+    Node * const victim = m_list.head;
+    m_list.head = victim->next;
+    m_first[0] = m_list.head;
+    delete victim;
+    shrink(0);
+  }
+
+  /**
+   * @brief Remove the node at position i + 1.
+   */
+  void erase_after(size_t i)
+  {
+    assert(i + 1 < m_size);
+    auto [b, offset] = locate(i + 1);
+    Node * prev = at(i);
+    Node * const victim = prev->next;
+    prev->next = victim->next;
+    if (offset == 0) m_first[b] = victim->next;
+    delete victim;
+    shrink(b);
+  }
+
+private:
+
+  /**
+   * @brief Find block index and offset within the block for position @p i.
+   */
+  std::pair<size_t, size_t> locate(size_t i) const
+  {
+    // Fenwick descent: largest prefix of blocks whose total length is <= i
+    size_t b = 0;
+    size_t step = 1;
+    while (2 * step <= m_tree.size()) step *= 2;
+    for (; step > 0; step /= 2)
+    {
+      if (b + step <= m_tree.size() && m_tree[b + step - 1] <= i)
+      {
+        b += step;
+        i -= m_tree[b - 1];
+      }
+    }
+    return { b, i };
+  }
+
+  void add(size_t b, std::ptrdiff_t delta)
+  {
+    for (++b; b <= m_tree.size(); b += b & (~b + 1))
+    {
+      m_tree[b - 1] += delta;
+    }
+  }
+
+  void rebuild_tree()
+  {
+    m_tree.assign(m_count.begin(), m_count.end());
+    for (size_t i = 1; i <= m_tree.size(); ++i)
+    {
+      size_t const parent = i + (i & (~i + 1));
+      if (parent <= m_tree.size()) m_tree[parent - 1] += m_tree[i - 1];
+    }
+  }
+
+  void grow(size_t b)
+  {
+    ++m_size;
+    ++m_count[b];
+    add(b, 1);
+    if (m_count[b] < 2 * m_block) return;
+
+    // split an oversized block in two halves
+    Node * mid = m_first[b];
+    for (size_t k = 0; k < m_block; ++k) mid = mid->next;
+    m_first.insert(m_first.begin() + b + 1, mid);
+    m_count.insert(m_count.begin() + b + 1, m_count[b] - m_block);
+    m_count[b] = m_block;
+    rebuild_tree();
+  }
+
+  void shrink(size_t b)
+  {
+    --m_size;
+    --m_count[b];
+    add(b, -1);
+    if (m_count[b] > 0) return;
+    m_first.erase(m_first.begin() + b);
+    m_count.erase(m_count.begin() + b);
+    rebuild_tree();
+  }
+
+  FwdList<T> & m_list;
+  size_t m_requested_block;
+  size_t m_block{};
+  size_t m_size{};
+  std::vector<Node *> m_first;
+  std::vector<size_t> m_count;
+  std::vector<size_t> m_tree;
+};
+
+/**
+ * Apply a random sequence of updates through the index and check lookups against a vector.
+ */
+void test_index(size_t num_ops, size_t block_size)
+{
+  std::mt19937 gen(num_ops + block_size);
+  FwdList<int> l{1,2,3};
+  std::vector<int> v{1,2,3};
+  FwdListIndex<int> index(l, block_size);
+  for (size_t i = 0; i < num_ops; ++i)
+  {
+    size_t const pos = std::uniform_int_distribution<size_t>(0, v.size() - 1)(gen);
+    switch (gen() % 4)
+    {
+      case 0:
+        index.push_front(int(i));
+        v.insert(v.begin(), int(i));
+        break;
+      case 1:
+        index.insert_after(pos, int(i));
+        v.insert(v.begin() + pos + 1, int(i));
+        break;
+      case 2:
+        if (v.size() > 1)
+        {
+          index.pop_front();
+          v.erase(v.begin());
+        }
+        break;
+      default:
+        if (pos + 1 < v.size())
+        {
+          index.erase_after(pos);
+          v.erase(v.begin() + pos + 1);
+        }
+    }
+  }
+  EXPECT_EQ(index.size(), v.size());
+  FwdList<int> e;
+  for (auto it = v.rbegin(); it != v.rend(); ++it) e.head = new FwdList<int>::Node{ e.head, *it };
+  EXPECT_EQ(l, e);
+  for (size_t n = 0; n < v.size(); ++n)
+  {
+    EXPECT_EQ(index.nth_to_last(n), v[v.size() - 1 - n]);
+    EXPECT_EQ(index.nth(n), v[n]);
+  }
+}
+
+/**
+ * Apply a random sequence of inserts and erases to an unrolled list with small nodes
+ * (to exercise splits and merges) and to a vector, then compare contents and lookups.
+ */
+void test_unrolled(size_t num_ops)
+{
+  std::mt19937 gen(num_ops);
+  UnrolledList<int, 4> l;
+  std::vector<int> v;
+  for (size_t i = 0; i < num_ops; ++i)
+  {
+    size_t const pos = std::uniform_int_distribution<size_t>(0, v.size())(gen);
+    auto it = l.begin();
+    std::advance(it, pos);
+    if (pos < v.size() && gen() % 3 == 0)
+    {
+      l.erase(it);
+      v.erase(v.begin() + pos);
+    }
+    else
+    {
+      EXPECT_EQ(*l.insert(it, int(i)), int(i));
+      v.insert(v.begin() + pos, int(i));
+    }
+  }
+  EXPECT_EQ(l.size(), v.size());
+  EXPECT(std::equal(l.begin(), l.end(), v.begin(), v.end()));
+  for (size_t n = 0; n < v.size(); ++n)
+  {
+    EXPECT_EQ(nth_to_last(l, n), v[v.size() - 1 - n]);
+  }
+  while (!l.empty()) l.erase(l.begin());
+  EXPECT(l.head == nullptr && l.tail == nullptr);
+}
+
+void bench()
+{
+  size_t const n = 10'000'000;
+  using Node = FwdList<int>::Node;
+
+  FwdList<int> fl;
+  benchmark::Timer timer;
+  Node * last = nullptr;
+  for (size_t i = 0; i < n; ++i)
+  {
+    Node * const node = new Node{ nullptr, int(i) };
+    (last ? last->next : fl.head) = node;
+    last = node;
+  }
+  benchmark::report("FwdList append", n, timer.seconds());
+
+  UnrolledList<int> ul;
+  timer = {};
+  for (size_t i = 0; i < n; ++i) ul.push_back(int(i));
+  benchmark::report("UnrolledList append", n, timer.seconds());
+
+  long sum = 0;
+  double t = benchmark::measure([&]{ for (auto p = fl.head; p; p = p->next) sum += p->val; });
+  benchmark::report("FwdList traverse", n, t);
+  t = benchmark::measure([&]{ for (int v : ul) sum += v; });
+  benchmark::report("UnrolledList traverse", n, t);
+  benchmark::do_not_optimize(sum);
+
+  t = benchmark::measure([&]{ benchmark::do_not_optimize(nth_to_last(fl, n / 2)); });
+  benchmark::report("FwdList nth_to_last", n, t);
+  t = benchmark::measure([&]{ benchmark::do_not_optimize(nth_to_last(ul, n / 2)); });
+  benchmark::report("UnrolledList nth_to_last", n, t);
+
+  size_t const num_queries = 1000;
+  std::mt19937 gen(1);
+  std::uniform_int_distribution<size_t> pick(0, n - 1);
+  t = benchmark::measure([&]{ for (size_t q = 0; q < 10; ++q) benchmark::do_not_optimize(nth_to_last(fl, pick(gen))); });
+  benchmark::report("FwdList nth_to_last x10", n, t);
+  timer = {};
+  FwdListIndex<int> index(fl);
+  benchmark::report("FwdListIndex build", n, timer.seconds());
+  t = benchmark::measure([&]{ for (size_t q = 0; q < num_queries; ++q) benchmark::do_not_optimize(index.nth_to_last(pick(gen))); });
+  benchmark::report("FwdListIndex nth_to_last (per query)", num_queries, t);
+  t = benchmark::measure([&]{ for (size_t q = 0; q < num_queries; ++q) index.insert_after(pick(gen), -1); });
+  benchmark::report("FwdListIndex insert_after (per op)", num_queries, t);
+
+  // insert a new value after every existing one
+  timer = {};
+  for (auto p = fl.head; p; p = p->next->next) p->next = new Node{ p->next, -1 };
+  benchmark::report("FwdList insert everywhere", n, timer.seconds());
+  timer = {};
+  for (auto it = ul.begin(); it != ul.end(); ++it) it = ul.insert(++it, -1);
+  benchmark::report("UnrolledList insert everywhere", n, timer.seconds());
+}
+
+int main(int argc, char ** argv)
 {
   EXPECT_EQ(nth_to_last<int>({1}, 0), 1);
   EXPECT_EQ(nth_to_last<int>({1,2}, 0), 2);
@@ -32,5 +399,19 @@ int main()
   EXPECT_EQ(nth_to_last<int>({3,2,1}, 2), 3);
   EXPECT_EQ(nth_to_last<int>({3,2,1}, 1), 2);
   EXPECT_EQ(nth_to_last<int>({3,2,1}, 0), 1);
+
+  EXPECT_EQ((nth_to_last(UnrolledList<int>{1}, 0)), 1);
+  EXPECT_EQ((nth_to_last(UnrolledList<int, 2>{3,2,1}, 2)), 3);
+  EXPECT_EQ((nth_to_last(UnrolledList<int, 2>{3,2,1}, 1)), 2);
+  EXPECT_EQ((nth_to_last(UnrolledList<int, 2>{3,2,1}, 0)), 1);
+  test_unrolled(10);
+  test_unrolled(100);
+  test_unrolled(1000);
+  test_index(10, 0);
+  test_index(1000, 0);
+  test_index(1000, 1);
+  test_index(1000, 4);
+
+  if (benchmark::requested(argc, argv)) bench();
   return testing::summary();
 }
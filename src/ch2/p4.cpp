@@ -1,7 +1,15 @@
 #include "List.hpp"
+#include "UnrolledList.hpp"
+#include "PoolList.hpp"
 #include "testing.hpp"
+#include "benchmark.hpp"
+#include "parallel.hpp"
 
 #include <cassert>
+#include <vector>
+#include <random>
+#include <algorithm>
+#include <string>
 
 /**
  * @brief Partition a list.
@@ -46,13 +54,245 @@ void partition(FwdList<T> & l, T const pivot)
   }
 }
 
+/**
+ * @brief Partition a list.
+ *
+ * Same for an unrolled list. Values can't be relinked individually, so they are
+ * streamed into two fresh lists (densely packed) whose node chains are then joined.
+ * Time complexity: O(N).
+ * Space complexity: O(N/K) extra nodes at any time, as source nodes are freed while consumed.
+ */
+template<typename T, size_t K>
+void partition(UnrolledList<T, K> & l, T const pivot)
+{
+  UnrolledList<T, K> lo, hi;
+  while (l.head)
+  {
+    auto * const node = l.head;
+    for (size_t i = 0; i < node->count; ++i)
+    {
+      (node->vals[i] < pivot ? lo : hi).push_back(std::move(node->vals[i]));
+    }
+    l.head = node->next;
+    delete node;
+  }
+  l.tail = nullptr;
+  l.length = 0;
+
+  // join node chains: lo followed by hi
+  if (lo.tail) lo.tail->next = hi.head;
+  if (hi.head) hi.head->prev = lo.tail;
+  l.head = lo.head ? lo.head : hi.head;
+  l.tail = hi.tail ? hi.tail : lo.tail;
+  l.length = lo.length + hi.length;
+  lo.head = lo.tail = hi.head = hi.tail = nullptr;
+}
+
+/**
+ * @brief Partition a list.
+ *
+ * Same for a pool-backed list, moving each smaller node to the end of the left partition with splice().
+ * Time complexity: O(N).
+ * Space complexity: O(1).
+ */
+template<typename T>
+void partition(PoolList<T> & l, T const pivot)
+{
+  using index_type = typename PoolList<T>::index_type;
+  auto const npos = PoolList<T>::npos;
+
+  // r is the last node of left partition
+  index_type r = npos;
+  for (index_type curr = l.head; curr != npos; )
+  {
+    index_type const next = l.next[curr];
+    if (l.vals[curr] < pivot)
+    {
+      l.splice(r != npos ? l.next[r] : l.head, curr, curr);
+      r = curr;
+    }
+    curr = next;
+  }
+}
+
+namespace impl
+{
+/**
+ * @brief Append nodes [first, last) to per-bucket chains, preserving their order.
+ */
+template<typename Node, typename F>
+void distribute(Node * first, Node * const last, F const & bucket_of,
+                std::vector<Node *> & heads, std::vector<Node *> & tails)
+{
+  for (Node * n = first; n != last; n = n->next)
+  {
+    size_t const b = bucket_of(n->val);
+    assert(b < heads.size());
+    if (tails[b]) tails[b]->next = n;
+    else heads[b] = n;
+    tails[b] = n;
+  }
+}
+}
+
+/**
+ * @brief Partition a list into k buckets.
+ *
+ * Stable k-way generalization of partition: reorder the list so that nodes of bucket 0
+ * come first, then bucket 1, etc., where bucket_of(value) returns a bucket in [0, k).
+ * Nodes are appended to per-bucket head/tail chains in one pass, then the chains are concatenated.
+ * Time complexity: O(N + k).
+ * Space complexity: O(k).
+ */
+template<typename T, typename F>
+void partition_k(FwdList<T> & l, size_t const k, F const & bucket_of)
+{
+  using Node = typename FwdList<T>::Node;
+  std::vector<Node *> heads(k), tails(k);
+  impl::distribute(l.head, static_cast<Node *>(nullptr), bucket_of, heads, tails);
+
+  Node * last = nullptr;
+  for (size_t b = 0; b < k; ++b)
+  {
+    if (!heads[b]) continue;
+    (last ? last->next : l.head) = heads[b];
+    last = tails[b];
+  }
+  if (last) last->next = nullptr;
+}
+
+/**
+ * @brief Partition a list into k buckets.
+ *
+ * Parallel version. One sequential pass samples every few thousandth node to cut the list
+ * into roughly equal segments; each thread then distributes its segment into its own
+ * per-bucket chains, and chains are concatenated bucket by bucket, thread by thread.
+ * Time complexity: O(N/P + N/S + P*k) for P threads and sampling stride S.
+ * Space complexity: O(P*k + N/S).
+ */
+template<typename T, typename F>
+void partition_k_parallel(FwdList<T> & l, size_t const k, F const & bucket_of,
+                          unsigned num_threads = parallel::default_threads())
+{
+  using Node = typename FwdList<T>::Node;
+  size_t const stride = 1024;
+
+  std::vector<Node *> samples;
+  size_t i = 0;
+  for (Node * n = l.head; n; n = n->next, ++i)
+  {
+    if (i % stride == 0) samples.push_back(n);
+  }
+  samples.push_back(nullptr);
+
+  size_t const num_segments = std::min<size_t>(num_threads, samples.size() - 1);
+  std::vector<std::vector<Node *>> heads(num_segments, std::vector<Node *>(k));
+  std::vector<std::vector<Node *>> tails(num_segments, std::vector<Node *>(k));
+  parallel::for_chunks(num_segments, static_cast<unsigned>(num_segments), [&](unsigned, size_t b, size_t e)
+  {
+    for (size_t s = b; s < e; ++s)
+    {
+      Node * const first = samples[(samples.size() - 1) * s / num_segments];
+      Node * const last = samples[(samples.size() - 1) * (s + 1) / num_segments];
+      impl::distribute(first, last, bucket_of, heads[s], tails[s]);
+    }
+  });
+
+  Node * last = nullptr;
+  for (size_t b = 0; b < k; ++b)
+  {
+    for (size_t s = 0; s < num_segments; ++s)
+    {
+      if (!heads[s][b]) continue;
+      (last ? last->next : l.head) = heads[s][b];
+      last = tails[s][b];
+    }
+  }
+  if (last) last->next = nullptr;
+}
+
+template <typename L>
+L convert(FwdList<int> const & l)
+{
+  L res;
+  for (auto n = l.head; n; n = n->next)
+  {
+    if constexpr (std::is_same_v<L, PoolList<int>>) res.add_tail(n->val);
+    else res.push_back(n->val);
+  }
+  return res;
+}
+
 void test(FwdList<int> l, int const pivot, FwdList<int> const & e)
 {
+  using UL = UnrolledList<int, 2>;
+  UL ul = convert<UL>(l);
+  partition(ul, pivot);
+  EXPECT_EQ(ul, convert<UL>(e));
+
+  auto pl = convert<PoolList<int>>(l);
+  partition(pl, pivot);
+  EXPECT_EQ(pl, convert<PoolList<int>>(e));
+  pl.compact();
+  EXPECT_EQ(pl, convert<PoolList<int>>(e));
+  for (size_t i = 0; i + 1 < pl.size(); ++i) EXPECT_EQ(pl.next[i], i + 1);
+
+  FwdList<int> lk(l);
+  partition_k(lk, 2, [pivot](int v){ return v < pivot ? 0 : 1; });
+  EXPECT_EQ(lk, e);
+
   partition(l, pivot);
   EXPECT_EQ(l, e);
 }
 
-int main()
+FwdList<int> make_list(std::vector<int> const & v)
+{
+  FwdList<int> l;
+  for (auto it = v.rbegin(); it != v.rend(); ++it) l.head = new FwdList<int>::Node{ l.head, *it };
+  return l;
+}
+
+std::vector<int> make_input(size_t n)
+{
+  std::mt19937 gen(n);
+  std::vector<int> v(n);
+  for (auto & x : v) x = int(gen() % 1000);
+  return v;
+}
+
+void test_k(std::vector<int> const & v, size_t k)
+{
+  auto const bucket_of = [k](int x){ return size_t(x) % k; };
+  std::vector<int> e = v;
+  std::stable_sort(e.begin(), e.end(), [&](int a, int b){ return bucket_of(a) < bucket_of(b); });
+  FwdList<int> const expected = make_list(e);
+
+  FwdList<int> l = make_list(v);
+  partition_k(l, k, bucket_of);
+  EXPECT_EQ(l, expected);
+  for (unsigned threads : { 1, 2, 3, 8 })
+  {
+    FwdList<int> lp = make_list(v);
+    partition_k_parallel(lp, k, bucket_of, threads);
+    EXPECT_EQ(lp, expected);
+  }
+}
+
+void bench()
+{
+  size_t const n = 10'000'000;
+  FwdList<int> l = make_list(make_input(n));
+  for (size_t k : { 2, 16, 256 })
+  {
+    auto const bucket_of = [k](int x){ return size_t(x) % k; };
+    double t = benchmark::measure([&]{ partition_k(l, k, bucket_of); });
+    benchmark::report("partition_k k=" + std::to_string(k), n, t);
+    t = benchmark::measure([&]{ partition_k_parallel(l, k, bucket_of); });
+    benchmark::report("partition_k_parallel k=" + std::to_string(k), n, t);
+  }
+}
+
+int main(int argc, char ** argv)
 {
   test({}, 5, {});
   test({2,1}, 5, {2,1});
@@ -60,5 +300,15 @@ int main()
   test({2,1,6,5}, 5, {2,1,6,5});
   test({6,5,2,1}, 5, {2,1,6,5});
   test({3,5,8,5,10,2,1}, 5, {3,2,1,5,8,5,10});
+  test({1,7,2,8,3,9,4}, 5, {1,2,3,4,7,8,9});
+
+  test_k({}, 3);
+  test_k({5}, 3);
+  test_k({5,4,3,2,1,0}, 3);
+  test_k(make_input(100), 7);
+  test_k(make_input(10000), 1);
+  test_k(make_input(10000), 16);
+
+  if (benchmark::requested(argc, argv)) bench();
   return testing::summary();
 }
@@ -1,7 +1,12 @@
 #include "List.hpp"
+#include "BigInt.hpp"
 #include "testing.hpp"
+#include "benchmark.hpp"
 
 #include <utility>
+#include <vector>
+#include <random>
+#include <string>
 
 /**
  * @brief Sum Lists.
@@ -133,17 +138,228 @@ FwdList<T> sum_lists_forward(FwdList<T> const & a, FwdList<T> const & b)
   return FwdList<T>{ hr };
 }
 
+namespace impl
+{
+/**
+ * @brief Iterative forward-order addition with delayed carry propagation.
+ *
+ * Digits are summed in one pass from the most significant end. A carry can only
+ * ripple back through a run of 9s, so we remember the last digit that is not 9:
+ * on a carry, that digit is incremented and the 9s after it become 0s.
+ * Each digit is zeroed at most once, so the pass is linear.
+ * Nodes are obtained from make_node(), and the result uses at most max(Na, Nb) + 1 of them.
+ */
+template <typename T, typename MakeNode>
+typename FwdList<T>::Node *
+sum_lists_forward_iterative(typename FwdList<T>::Node * a, typename FwdList<T>::Node * b, MakeNode && make_node)
+{
+  using Node = typename FwdList<T>::Node;
+
+  size_t la = 0;
+  for (auto n = a; n; n = n->next) ++la;
+  size_t lb = 0;
+  for (auto n = b; n; n = n->next) ++lb;
+  if (la < lb)
+  {
+    std::swap(a, b);
+    std::swap(la, lb);
+  }
+
+  // leading node absorbs the final carry, if any
+  Node * const head = make_node();
+  head->val = 0;
+  Node * tail = head;
+  Node * last_non9 = head;
+  for (size_t i = 0; i < la; ++i, a = a->next)
+  {
+    T sum = a->val;
+    if (i >= la - lb)
+    {
+      sum += b->val;
+      b = b->next;
+    }
+    Node * const node = make_node();
+    tail->next = node;
+    tail = node;
+    if (sum > 9)
+    {
+      ++last_non9->val;
+      for (Node * n = last_non9->next; n != node; n = n->next) n->val = 0;
+      sum -= 10;
+    }
+    node->val = sum;
+    if (sum != 9) last_non9 = node;
+  }
+  tail->next = nullptr;
+  return head;
+}
+}
+
+/**
+ * @brief Sum Lists.
+ *
+ * Add two numbers represented as singly linked lists of digits.
+ * This version is for forward representation (most significant digit first),
+ * implemented without recursion so it works for numbers of any length.
+ * Time complexity: O(max(Na, Nb)).
+ * Space complexity: O(1), not including space for result.
+ */
+template <typename T>
+FwdList<T> sum_lists_forward_iterative(FwdList<T> const & a, FwdList<T> const & b)
+{
+  using Node = typename FwdList<T>::Node;
+  Node * head = impl::sum_lists_forward_iterative<T>(a.head, b.head, []{ return new Node(); });
+  if (head->val == 0)
+  {
+    Node * const tmp = head;
+    head = head->next;
+    delete tmp;
+  }
+  return FwdList<T>{ head };
+}
+
+/**
+ * @brief Sum Lists.
+ *
+ * Same as above, but all result nodes are placed in a caller-provided pool,
+ * resized up front to max(Na, Nb) + 1 nodes, instead of individually allocated.
+ * Returns the first result node (or null for empty inputs); nodes are owned by the pool,
+ * so the result must not be wrapped into a FwdList.
+ */
+template <typename T>
+typename FwdList<T>::Node *
+sum_lists_forward_pooled(FwdList<T> const & a, FwdList<T> const & b, std::vector<typename FwdList<T>::Node> & pool)
+{
+  size_t len = 0;
+  for (auto n = a.head, m = b.head; n || m; n = n ? n->next : n, m = m ? m->next : m) ++len;
+  pool.clear();
+  pool.resize(len + 1);
+  size_t used = 0;
+  auto head = impl::sum_lists_forward_iterative<T>(a.head, b.head, [&]{ return &pool[used++]; });
+  return head->val == 0 ? head->next : head;
+}
+
 void test_reverse(FwdList<int> const & a, FwdList<int> const & b, FwdList<int> const & e)
 {
   EXPECT_EQ(sum_lists_reverse(a, b), e);
+  EXPECT_EQ(BigUInt::from_list_reverse(a) + BigUInt::from_list_reverse(b), BigUInt::from_list_reverse(e));
 }
 
 void test_forward(FwdList<int> const & a, FwdList<int> const & b, FwdList<int> const & e)
 {
   EXPECT_EQ(sum_lists_forward(a, b), e);
+  EXPECT_EQ(sum_lists_forward_iterative(a, b), e);
+  std::vector<FwdList<int>::Node> pool;
+  FwdList<int> pooled(sum_lists_forward_pooled(a, b, pool));
+  EXPECT_EQ(pooled, e);
+  pooled.head = nullptr; // nodes belong to the pool
+  EXPECT_EQ(BigUInt::from_list_forward(a) + BigUInt::from_list_forward(b), BigUInt::from_list_forward(e));
+}
+
+std::string random_digits(std::mt19937 & gen, size_t n)
+{
+  std::string s(n, '0');
+  for (auto & c : s) c = char('0' + gen() % 10);
+  if (n > 0 && s[0] == '0') s[0] = '1';
+  return s;
+}
+
+/**
+ * Check big number arithmetic on random operands of the given sizes against identities,
+ * the digit-list adder, and (for multiplication) the schoolbook product.
+ */
+void test_bignum(size_t na, size_t nb)
+{
+  std::mt19937 gen(na * 31 + nb);
+  std::string const sa = random_digits(gen, na);
+  std::string const sb = random_digits(gen, nb);
+  BigUInt const a(sa);
+  BigUInt const b(sb);
+
+  EXPECT_EQ(BigUInt(a.to_string()), a);
+  EXPECT_EQ(a.to_string(), na > 0 ? sa : "0");
+  EXPECT_EQ(BigUInt::from_list_reverse(a.to_list_reverse<int>()), a);
+  EXPECT_EQ(BigUInt::from_list_forward(a.to_list_forward<int>()), a);
+
+  auto const sum = a + b;
+  EXPECT_EQ(sum_lists_forward_iterative(a.to_list_forward<int>(), b.to_list_forward<int>()), sum.to_list_forward<int>());
+  EXPECT_EQ(sum - b, a);
+  EXPECT_EQ(sum - a, b);
+  EXPECT_EQ(sum_lists_reverse(a.to_list_reverse<int>(), b.to_list_reverse<int>()), sum.to_list_reverse<int>());
+
+  auto const prod = a * b;
+  EXPECT_EQ(prod, b * a);
+  EXPECT_EQ((a + b) * (a + b), a * a + prod + prod + b * b);
+  std::vector<bigint::limb_t> expected(a.limbs().size() + b.limbs().size());
+  bigint::mul_schoolbook(expected.data(), a.limbs().data(), a.limbs().size(), b.limbs().data(), b.limbs().size());
+  EXPECT_EQ(prod, BigUInt(expected));
 }
 
-int main()
+void bench()
+{
+  std::mt19937_64 gen(1);
+  auto const make = [&](size_t digits)
+  {
+    std::vector<bigint::limb_t> limbs(size_t(digits * 3.3219280948873623 / 64) + 1);
+    for (auto & l : limbs) l = gen();
+    return BigUInt(limbs);
+  };
+  for (size_t digits : { 10'000, 1'000'000 })
+  {
+    std::string const suffix = " digits=" + std::to_string(digits);
+    std::mt19937 g(digits);
+    auto const make_list = [&]
+    {
+      FwdList<int> l;
+      for (char c : random_digits(g, digits)) l.head = new FwdList<int>::Node{ l.head, c - '0' };
+      return l;
+    };
+    FwdList<int> const la = make_list();
+    FwdList<int> const lb = make_list();
+    double t = 0.0;
+    if (digits <= 10'000) // recursion would overflow the stack on longer inputs
+    {
+      t = benchmark::measure([&]{ benchmark::do_not_optimize(sum_lists_forward(la, lb).head); });
+      benchmark::report("sum_lists_forward" + suffix, digits, t);
+    }
+    t = benchmark::measure([&]{ benchmark::do_not_optimize(sum_lists_forward_iterative(la, lb).head); });
+    benchmark::report("sum_lists_forward_iterative" + suffix, digits, t);
+    std::vector<FwdList<int>::Node> pool;
+    t = benchmark::measure([&]{ benchmark::do_not_optimize(sum_lists_forward_pooled(la, lb, pool)); });
+    benchmark::report("sum_lists_forward_pooled" + suffix, digits, t);
+  }
+
+  for (size_t digits : { 1'000, 10'000, 100'000, 1'000'000 })
+  {
+    BigUInt const a = make(digits);
+    BigUInt const b = make(digits);
+    std::string const suffix = " digits=" + std::to_string(digits);
+    double t = benchmark::measure([&]{ benchmark::do_not_optimize(a + b); });
+    benchmark::report("BigUInt add" + suffix, digits, t);
+    if (digits <= 100'000)
+    {
+      FwdList<int> const la = a.to_list_reverse<int>();
+      FwdList<int> const lb = b.to_list_reverse<int>();
+      t = benchmark::measure([&]{ benchmark::do_not_optimize(sum_lists_reverse(la, lb).head); });
+      benchmark::report("sum_lists_reverse" + suffix, digits, t);
+      t = benchmark::measure([&]{ benchmark::do_not_optimize(BigUInt::from_list_reverse(la)); });
+      benchmark::report("BigUInt from list" + suffix, digits, t);
+      t = benchmark::measure([&]{ benchmark::do_not_optimize(a.to_list_reverse<int>().head); });
+      benchmark::report("BigUInt to list" + suffix, digits, t);
+      t = benchmark::measure([&]
+      {
+        std::vector<bigint::limb_t> r(a.limbs().size() + b.limbs().size());
+        bigint::mul_schoolbook(r.data(), a.limbs().data(), a.limbs().size(), b.limbs().data(), b.limbs().size());
+        benchmark::do_not_optimize(r.back());
+      }, 1);
+      benchmark::report("BigUInt mul schoolbook" + suffix, digits, t);
+    }
+    t = benchmark::measure([&]{ benchmark::do_not_optimize(a * b); }, 1);
+    benchmark::report("BigUInt mul karatsuba" + suffix, digits, t);
+  }
+}
+
+int main(int argc, char ** argv)
 {
   test_reverse({}, {}, {});
   test_reverse({1}, {1}, {2});
@@ -160,5 +376,24 @@ int main()
   test_forward({5}, {1,6}, {2,1});
   test_forward({6,1,7}, {2,9,5}, {9,1,2});
   test_forward({8,7,9}, {5,8,6}, {1,4,6,5});
+  test_forward({9,9,9}, {1}, {1,0,0,0});
+  test_forward({4,9,9,5}, {5}, {5,0,0,0});
+  test_forward({9,4,9,9}, {5,0,1}, {1,0,0,0,0});
+  test_forward({1,9,9}, {7,0,0}, {8,9,9});
+
+  test_bignum(0, 0);
+  test_bignum(1, 0);
+  test_bignum(19, 20);
+  test_bignum(100, 3);
+  test_bignum(1000, 1000);
+  test_bignum(3000, 700);
+  test_bignum(5000, 5000);
+  // force Karatsuba recursion all the way down to its smallest size
+  bigint::karatsuba_threshold = 4;
+  test_bignum(333, 333);
+  test_bignum(500, 123);
+  bigint::karatsuba_threshold = 32;
+
+  if (benchmark::requested(argc, argv)) bench();
   return testing::summary();
 }
@@ -1,7 +1,11 @@
 #include "List.hpp"
 #include "testing.hpp"
+#include "benchmark.hpp"
 
 #include <utility>
+#include <vector>
+#include <algorithm>
+#include <type_traits>
 
 template <typename T>
 std::pair<typename FwdList<T>::Node *, bool>
@@ -31,15 +35,120 @@ bool is_palindrome(FwdList<T> const & l)
   return result;
 }
 
-int main()
+template <typename Node>
+Node * reverse(Node * head)
 {
-  EXPECT(is_palindrome<int>({}));
-  EXPECT(is_palindrome<int>({1}));
-  EXPECT(is_palindrome<int>({1,2,1}));
-  EXPECT(is_palindrome<int>({2,1,1,2}));
-  EXPECT(is_palindrome<int>({3,5,1,5,3}));
-  EXPECT(!is_palindrome<int>({1,2}));
-  EXPECT(!is_palindrome<int>({1,2,3}));
-  EXPECT(!is_palindrome<int>({2,3,1,4,2}));
+  Node * prev = nullptr;
+  while (head)
+  {
+    Node * const next = head->next;
+    head->next = prev;
+    prev = head;
+    head = next;
+  }
+  return prev;
+}
+
+/**
+ * @brief Is Palindrome.
+ *
+ * Constant-space version: find the middle with slow/fast pointers, reverse the second half
+ * in place, compare it against the first half, then reverse it back.
+ * The list is temporarily modified, so it must not be accessed concurrently.
+ * Time complexity: O(N).
+ * Space complexity: O(1).
+ */
+template <typename T>
+bool is_palindrome_inplace(FwdList<T> & l)
+{
+  if (!l.head || !l.head->next) return true;
+
+  // slow stops at the last node of the first half (the middle one for odd lengths)
+  auto slow = l.head;
+  for (auto fast = l.head; fast->next && fast->next->next; fast = fast->next->next)
+  {
+    slow = slow->next;
+  }
+
+  auto const second = reverse(slow->next);
+  bool result = true;
+  for (auto p1 = l.head, p2 = second; p2 && result; p1 = p1->next, p2 = p2->next)
+  {
+    result = p1->val == p2->val;
+  }
+  slow->next = reverse(second);
+  return result;
+}
+
+/**
+ * @brief Is Palindrome.
+ *
+ * Version for trivially copyable values: copy them into a contiguous buffer in one pass,
+ * then compare both ends of the buffer, which the compiler can vectorize.
+ * Time complexity: O(N).
+ * Space complexity: O(N).
+ */
+template <typename T>
+bool is_palindrome_buffered(FwdList<T> const & l)
+{
+  static_assert(std::is_trivially_copyable_v<T>, "values must be trivially copyable");
+  std::vector<T> buf;
+  for (auto n = l.head; n; n = n->next) buf.push_back(n->val);
+  return std::equal(buf.begin(), buf.begin() + buf.size() / 2, buf.rbegin());
+}
+
+void test(FwdList<int> l, bool e)
+{
+  FwdList<int> const copy(l);
+  EXPECT_EQ(is_palindrome(l), e);
+  EXPECT_EQ(is_palindrome_inplace(l), e);
+  EXPECT_EQ(l, copy);
+  EXPECT_EQ(is_palindrome_buffered(l), e);
+}
+
+FwdList<int> make_palindrome(size_t n)
+{
+  FwdList<int> l;
+  for (size_t i = 0; i < n; ++i)
+  {
+    l.head = new FwdList<int>::Node{ l.head, int(std::min(i, n - 1 - i) % 1000) };
+  }
+  return l;
+}
+
+void bench()
+{
+  for (size_t n : { 100'000, 10'000'000 })
+  {
+    FwdList<int> l = make_palindrome(n);
+    double t = 0.0;
+    if (n <= 100'000) // deeper recursion would overflow the stack
+    {
+      t = benchmark::measure([&]{ benchmark::do_not_optimize(is_palindrome(l)); });
+      benchmark::report("is_palindrome (recursive)", n, t);
+    }
+    t = benchmark::measure([&]{ benchmark::do_not_optimize(is_palindrome_inplace(l)); });
+    benchmark::report("is_palindrome_inplace", n, t);
+    t = benchmark::measure([&]{ benchmark::do_not_optimize(is_palindrome_buffered(l)); });
+    benchmark::report("is_palindrome_buffered", n, t);
+  }
+}
+
+int main(int argc, char ** argv)
+{
+  test({}, true);
+  test({1}, true);
+  test({1,2,1}, true);
+  test({2,1,1,2}, true);
+  test({3,5,1,5,3}, true);
+  test({1,2}, false);
+  test({1,2,3}, false);
+  test({2,3,1,4,2}, false);
+  test({1,1}, true);
+  test({1,2,2,3}, false);
+  test(make_palindrome(1001), true);
+  test(make_palindrome(1000), true);
+
+  if (benchmark::requested(argc, argv)) bench();
   return testing::summary();
 }
@@ -1,5 +1,11 @@
 #include "List.hpp"
+#include "Hashing.hpp"
 #include "testing.hpp"
+#include "benchmark.hpp"
+
+#include <vector>
+#include <random>
+#include <algorithm>
 
 /**
  * @brief Intersection.
@@ -42,6 +48,87 @@ check_intersection(typename FwdList<T>::Node * a, typename FwdList<T>::Node * b)
   return shared;
 }
 
+template <typename T>
+struct IntersectionGroup
+{
+  std::vector<size_t> lists;        // indices of the input lists sharing a tail, ascending
+  typename FwdList<T>::Node * merge; // first node common to all of them
+};
+
+/**
+ * @brief Batch intersection.
+ *
+ * Given many lists (e.g. persistent lists that share structure), find every group of
+ * two or more lists that intersect and the node where all lists in the group merge.
+ * Lists are walked one after another, recording each node in a pointer-keyed hash map together
+ * with the list that reached it first and its position there. A walk stops at the first node already
+ * in the map, so every node is visited once overall, and the distance from that node to the shared
+ * tail follows from the recorded length of the list that owns it. A walk that reaches the end starts
+ * a new group, any other joins the group of the list it ran into. Every list of a group passes through
+ * its merge node, and no list can join the group closer to the tail than that, so the merge node is
+ * the join point nearest to the tail.
+ * Groups are returned in order of their first list. Empty lists never intersect.
+ * Time complexity: O(D + L) where D is the number of distinct nodes and L the number of lists
+ * Space complexity: O(D + L)
+ */
+template <typename T>
+std::vector<IntersectionGroup<T>>
+find_intersections(std::vector<typename FwdList<T>::Node *> const & heads)
+{
+  using Node = typename FwdList<T>::Node;
+  struct Visit
+  {
+    size_t list; // first list to reach the node
+    size_t pos;  // position of the node in that list
+  };
+  size_t const none = heads.size();
+
+  std::vector<size_t> lengths(heads.size()); // number of nodes in each list
+  std::vector<size_t> group_of(heads.size(), none);
+  std::vector<IntersectionGroup<T>> groups;
+  std::vector<size_t> merge_dist; // distance from each group's merge node to its tail
+  FlatHashMap<Node *, Visit> visited;
+  for (size_t i = 0; i < heads.size(); ++i)
+  {
+    size_t pos = 0;
+    Visit const * join = nullptr;
+    Node * n = heads[i];
+    for (; n; n = n->next, ++pos)
+    {
+      auto const [v, inserted] = visited.try_emplace(n, Visit{ i, pos });
+      if (!inserted)
+      {
+        join = v;
+        break;
+      }
+    }
+    if (pos == 0 && !join) continue;
+
+    if (!join)
+    {
+      lengths[i] = pos;
+      group_of[i] = groups.size();
+      groups.push_back({ { i }, nullptr });
+      merge_dist.push_back(pos + 1);
+      continue;
+    }
+    size_t const dist = lengths[join->list] - join->pos;
+    size_t const g = group_of[join->list];
+    lengths[i] = pos + dist;
+    group_of[i] = g;
+    groups[g].lists.push_back(i);
+    if (dist < merge_dist[g])
+    {
+      merge_dist[g] = dist;
+      groups[g].merge = n;
+    }
+  }
+
+  groups.erase(std::remove_if(groups.begin(), groups.end(), [](auto const & g) { return g.lists.size() < 2; }),
+               groups.end());
+  return groups;
+}
+
 /**
  * The test is constructed from two input lists and a number as follows:
  *  - if n < 0, lists are passed to algorithm as is and nullptr is the expected answer;
@@ -73,7 +160,109 @@ void test(FwdList<int> const & a, FwdList<int> const & b, int n)
   }
 }
 
-int main()
+/**
+ * Lists are built over a shared node pool (so that they can share structure) from
+ * sequences of pool indices; a sequence ending in an already linked node joins its list.
+ */
+void test_batch()
+{
+  using Node = FwdList<int>::Node;
+  std::vector<Node> pool(16);
+  for (size_t i = 0; i < pool.size(); ++i) pool[i].val = static_cast<int>(i);
+  auto chain = [&](std::vector<int> const & idx)
+  {
+    for (size_t k = 0; k + 1 < idx.size(); ++k) pool[idx[k]].next = &pool[idx[k + 1]];
+    return &pool[idx.front()];
+  };
+
+  // 0 -> 1 -> 2 -> 3, 4 -> 2, 5 -> 6 -> 3, 7 -> 8, 9 -> 8, 10 -> 11
+  Node * a = chain({0, 1, 2, 3});
+  Node * b = chain({4, 2});
+  Node * c = chain({5, 6, 3});
+  Node * d = chain({7, 8});
+  Node * e = chain({9, 8});
+  Node * f = chain({10, 11});
+
+  {
+    auto const groups = find_intersections<int>({a, b, nullptr, c, d, f, e, a});
+    EXPECT_EQ(groups.size(), 2u);
+    EXPECT((groups[0].lists == std::vector<size_t>{0, 1, 3, 7}));
+    EXPECT_EQ(groups[0].merge, &pool[3]);
+    EXPECT((groups[1].lists == std::vector<size_t>{4, 6}));
+    EXPECT_EQ(groups[1].merge, &pool[8]);
+  }
+  {
+    auto const groups = find_intersections<int>({a, b});
+    EXPECT_EQ(groups.size(), 1u);
+    EXPECT_EQ(groups[0].merge, check_intersection<int>(a, b));
+  }
+  {
+    // lists starting inside another one, and a list given twice
+    auto const groups = find_intersections<int>({&pool[2], b, a, a});
+    EXPECT_EQ(groups.size(), 1u);
+    EXPECT((groups[0].lists == std::vector<size_t>{0, 1, 2, 3}));
+    EXPECT_EQ(groups[0].merge, &pool[2]);
+    auto const twice = find_intersections<int>({a, a});
+    EXPECT_EQ(twice.size(), 1u);
+    EXPECT_EQ(twice[0].merge, a);
+  }
+  EXPECT(find_intersections<int>({}).empty());
+  EXPECT(find_intersections<int>({nullptr, nullptr}).empty());
+  EXPECT(find_intersections<int>({a, d, f}).empty());
+}
+
+/**
+ * Many lists sharing structure: each new list is a short fresh prefix attached
+ * at a random node of a previously built list (like versions of a persistent list).
+ * Compares the batch call against checking every list against the first one pairwise,
+ * which is already O(L * N) and still finds only the groups containing list 0.
+ */
+void bench()
+{
+  using Node = FwdList<int>::Node;
+  std::mt19937 gen(42);
+  for (size_t const num_lists : {1000u, 10000u})
+  {
+    size_t const num_roots = 16;
+    size_t const prefix = 16;
+    std::vector<Node> pool(num_roots * 64 + num_lists * prefix);
+    std::vector<Node *> heads;
+    std::vector<std::vector<Node *>> nodes_of; // nodes of each list, to pick attach points
+    size_t used = 0;
+    for (size_t i = 0; i < num_lists; ++i)
+    {
+      size_t const len = i < num_roots ? 64 : prefix;
+      Node * const first = &pool[used];
+      for (size_t k = 0; k + 1 < len; ++k) pool[used + k].next = &pool[used + k + 1];
+      std::vector<Node *> own;
+      for (size_t k = 0; k < len; ++k) own.push_back(&pool[used + k]);
+      used += len;
+      if (i >= num_roots)
+      {
+        auto const & base = nodes_of[std::uniform_int_distribution<size_t>(0, i - 1)(gen)];
+        own.back()->next = base[std::uniform_int_distribution<size_t>(0, base.size() - 1)(gen)];
+        for (Node * n = own.back()->next; n; n = n->next) own.push_back(n);
+      }
+      heads.push_back(first);
+      nodes_of.push_back(std::move(own));
+    }
+    size_t total = 0;
+    for (auto const & v : nodes_of) total += v.size();
+
+    benchmark::report("find_intersections", total, benchmark::measure([&]
+    {
+      benchmark::do_not_optimize(find_intersections<int>(heads).size());
+    }));
+    benchmark::report("check_intersection vs list 0", total, benchmark::measure([&]
+    {
+      size_t found = 0;
+      for (size_t i = 1; i < heads.size(); ++i) found += check_intersection<int>(heads[0], heads[i]) != nullptr;
+      benchmark::do_not_optimize(found);
+    }));
+  }
+}
+
+int main(int argc, char ** argv)
 {
   test({},{},-1);
   test({1,2},{3,4},-1);
@@ -81,5 +270,7 @@ int main()
   test({1,2,3},{},1);
   test({1},{2,3},0);
   test({1,2,3},{1},2);
+  test_batch();
+  if (benchmark::requested(argc, argv)) bench();
   return testing::summary();
 }
@@ -1,5 +1,15 @@
 #include "List.hpp"
 #include "testing.hpp"
+#include "benchmark.hpp"
+
+#include <vector>
+#include <map>
+#include <numeric>
+#include <random>
+#include <algorithm>
+#include <string>
+#include <utility>
+#include <cstdint>
 
 /**
  * @brief Loop Detection.
@@ -37,6 +47,102 @@ find_loop_start(FwdList<T> const & l)
   return ps;
 }
 
+template <typename S>
+struct CycleInfo
+{
+  S start;            // first state on the cycle, or the terminal state if there is no cycle
+  size_t loop_length; // number of states on the cycle, 0 if there is no cycle
+  size_t tail_length; // number of states before the cycle (or before the terminal state)
+};
+
+/**
+ * @brief Cycle detection on an arbitrary successor function (Brent's algorithm).
+ *
+ * Follows x0, next(x0), next(next(x0)), ... until either a state satisfying is_end is reached
+ * (a state without successor, such as nullptr) or a state repeats.
+ * The hare advances one step at a time and the tortoise teleports to the hare whenever the step
+ * count reaches a power of two, so each step costs one evaluation of next() instead of Floyd's three,
+ * and the loop length falls out of the detection phase for free.
+ * The loop start is then found by running two cursors loop_length steps apart from x0.
+ * Time complexity: O(mu + lambda) evaluations of next(), where mu is tail length and lambda is loop length.
+ * Space complexity: O(1).
+ */
+template <typename S, typename Next, typename IsEnd>
+CycleInfo<S> find_cycle(S const & x0, Next && next, IsEnd && is_end)
+{
+  if (is_end(x0)) return { x0, 0, 0 };
+
+  // Detect the cycle and its length
+  size_t power = 1;
+  size_t lambda = 1;
+  size_t steps = 1;
+  S tortoise = x0;
+  S hare = next(x0);
+  while (!(tortoise == hare))
+  {
+    if (is_end(hare)) return { hare, 0, steps };
+    if (power == lambda)
+    {
+      tortoise = hare;
+      power *= 2;
+      lambda = 0;
+    }
+    hare = next(hare);
+    ++lambda;
+    ++steps;
+  }
+
+  // Find the start of the cycle with two cursors lambda steps apart
+  tortoise = x0;
+  hare = x0;
+  for (size_t i = 0; i < lambda; ++i) hare = next(hare);
+  size_t mu = 0;
+  for (; !(tortoise == hare); ++mu)
+  {
+    tortoise = next(tortoise);
+    hare = next(hare);
+  }
+  return { tortoise, lambda, mu };
+}
+
+/**
+ * @brief Cycle detection on a successor function that is defined everywhere (every sequence cycles).
+ */
+template <typename S, typename Next>
+CycleInfo<S> find_cycle(S const & x0, Next && next)
+{
+  return find_cycle(x0, std::forward<Next>(next), [](S const &) { return false; });
+}
+
+/**
+ * @brief Loop start, loop length and tail length of a list.
+ *
+ * If the list has no loop, start is nullptr, loop_length is 0 and tail_length is the length of the list.
+ * Time complexity: O(N).
+ * Space complexity: O(1).
+ */
+template <typename T>
+CycleInfo<typename FwdList<T>::Node *>
+find_loop(FwdList<T> const & l)
+{
+  using Node = typename FwdList<T>::Node;
+  return find_cycle(l.head, [](Node * n) { return n->next; }, [](Node * n) { return n == nullptr; });
+}
+
+/**
+ * @brief Loop Detection (Brent's algorithm).
+ *
+ * Same result as find_loop_start, with about a third of the pointer dereferences.
+ * Time complexity: O(N).
+ * Space complexity: O(1).
+ */
+template <typename T>
+typename FwdList<T>::Node *
+find_loop_start_brent(FwdList<T> const & l)
+{
+  return find_loop(l).start;
+}
+
 /**
  * Test is constructed as follows: given a valid (non-cicular) list and a number n,
  * we attach the tail node of the list to its n-th node to create a loop, and expect n-th node as answer.
@@ -55,10 +161,67 @@ void test(FwdList<int> const & l, int n)
   if (k == n) nth = last;
   if (nth) last->next = nth;
   EXPECT_EQ(find_loop_start(l), nth);
+  EXPECT_EQ(find_loop_start_brent(l), nth);
+  auto const info = find_loop(l);
+  EXPECT_EQ(info.loop_length, nth ? static_cast<size_t>(k - n + 1) : 0u);
+  EXPECT_EQ(info.tail_length, nth ? static_cast<size_t>(n) : static_cast<size_t>(l.head ? k + 1 : 0));
   if (nth) last->next = nullptr;
 }
 
-int main()
+/**
+ * Check the generic form against a brute-force walk that remembers the first visit of every state.
+ */
+void test_generic(std::uint64_t x0, std::uint64_t m)
+{
+  auto next = [m](std::uint64_t x) { return (x * x + 1) % m; };
+  std::map<std::uint64_t, size_t> first_visit;
+  std::uint64_t x = x0;
+  for (size_t i = 0; first_visit.emplace(x, i).second; ++i) x = next(x);
+  size_t const mu = first_visit[x];
+
+  auto const info = find_cycle(x0, next);
+  EXPECT_EQ(info.start, x);
+  EXPECT_EQ(info.tail_length, mu);
+  EXPECT_EQ(info.loop_length, first_visit.size() - mu);
+}
+
+/**
+ * Lists of n nodes whose tail links back to the middle node, so both tail and loop are n/2 long.
+ * Nodes live in one array; "sequential" links them in storage order, "shuffled" in random order,
+ * which makes every step a likely cache miss and exposes the per-step dereference count.
+ */
+void bench()
+{
+  using Node = FwdList<int>::Node;
+  std::mt19937 gen(42);
+  for (size_t const n : {1000000u, 10000000u})
+  {
+    std::vector<Node> pool(n);
+    std::vector<size_t> order(n);
+    for (bool const shuffled : {false, true})
+    {
+      std::iota(order.begin(), order.end(), 0);
+      if (shuffled) std::shuffle(order.begin(), order.end(), gen);
+      for (size_t i = 0; i + 1 < n; ++i) pool[order[i]].next = &pool[order[i + 1]];
+      pool[order[n - 1]].next = &pool[order[n / 2]];
+
+      FwdList<int> l;
+      l.head = &pool[order[0]];
+      char const * suffix = shuffled ? " (shuffled)" : " (sequential)";
+      benchmark::report(std::string("find_loop_start floyd") + suffix, n, benchmark::measure([&]
+      {
+        benchmark::do_not_optimize(find_loop_start(l));
+      }));
+      benchmark::report(std::string("find_loop_start brent") + suffix, n, benchmark::measure([&]
+      {
+        benchmark::do_not_optimize(find_loop_start_brent(l));
+      }));
+      l.head = nullptr; // nodes are owned by the pool
+    }
+  }
+}
+
+int main(int argc, char ** argv)
 {
   test({}, -1);
   test({1}, 0);
@@ -67,5 +230,17 @@ int main()
   test({1,2,3,4,5,6}, 4);
   test({1,2,3,4,5,6,7}, 1);
   test({1,2,3,4,5,6,7}, 0);
+  test_generic(0, 1);
+  test_generic(2, 97);
+  test_generic(3, 1000003);
+  test_generic(7, 1 << 20);
+  {
+    // terminating sequence: Collatz steps from 27 until reaching 1
+    auto const info = find_cycle(27, [](int x) { return x % 2 ? 3 * x + 1 : x / 2; }, [](int x) { return x == 1; });
+    EXPECT_EQ(info.start, 1);
+    EXPECT_EQ(info.loop_length, 0u);
+    EXPECT_EQ(info.tail_length, 111u);
+  }
+  if (benchmark::requested(argc, argv)) bench();
   return testing::summary();
 }
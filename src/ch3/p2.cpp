@@ -1,8 +1,33 @@
-#include <stack>
+#include "benchmark.hpp"
+
 #include <vector>
+#include <deque>
+#include <string>
+#include <random>
+#include <limits>
+#include <iterator>
+#include <functional>
+#include <algorithm>
+#include <utility>
+#include <type_traits>
 #include <cassert>
+#include <cstdint>
+#include <cstddef>
 
-template <typename T>
+/**
+ * @brief Stack Min.
+ *
+ * A stack that also reports its minimum in O(1).
+ * Minima are kept run-length encoded: a second stack of (value, count) pairs
+ * gets a new entry only when a strictly smaller value is pushed, and repeated
+ * pushes of the current minimum just bump its count. Ascending or repeated
+ * sequences therefore add nothing beyond the values themselves.
+ * The ordering is given by Compare, so MinStack<T, std::greater<T>> tracks the maximum.
+ * Count is the type of run lengths; a run that reaches its maximum is continued by a new run.
+ * Time complexity: O(1) per operation (amortized for push).
+ * Space complexity: O(N) values plus O(R) runs, R <= N number of distinct minima on the stack.
+ */
+template <typename T, typename Compare = std::less<T>, typename Count = std::uint32_t>
 class MinStack
 {
 public:
@@ -11,10 +36,16 @@ public:
 
   void push(T const & val)
   {
-    m_values.push(val);
-    if (m_mins.empty() || val <= m_mins.top())
+    m_values.push_back(val);
+    if (m_mins.empty() || m_cmp(val, m_mins.back().first))
+    {
+      m_mins.emplace_back(val, 1);
+    }
+    else if (!m_cmp(m_mins.back().first, val))
     {
-      m_mins.push(val);
+      // another copy of the minimum: a full run is continued by a new run of the same value
+      if (m_mins.back().second == max_count) m_mins.emplace_back(m_mins.back().first, 1);
+      else ++m_mins.back().second;
     }
   }
 
@@ -22,24 +53,205 @@ public:
   T const & peek() const
   {
     assert(!empty());
-    return m_values.top();
+    return m_values.back();
   }
 
   [[nodiscard]]
   T const & min() const
   {
     assert(!empty());
-    return m_mins.top();
+    return m_mins.back().first;
   }
 
   void pop()
   {
     assert(!empty());
-    if (m_values.top() == m_mins.top())
+    if (!m_cmp(m_mins.back().first, m_values.back()) && --m_mins.back().second == 0)
     {
-      m_mins.pop();
+      m_mins.pop_back();
     }
-    m_values.pop();
+    m_values.pop_back();
+  }
+
+  [[nodiscard]]
+  bool empty() const
+  {
+    return m_values.empty();
+  }
+
+  [[nodiscard]]
+  size_t size() const
+  {
+    return m_values.size();
+  }
+
+  /**
+   * @brief Number of bytes held by the stack storage.
+   */
+  [[nodiscard]]
+  size_t memory_usage() const
+  {
+    return m_values.capacity() * sizeof(T) + m_mins.capacity() * sizeof(m_mins[0]);
+  }
+
+private:
+
+  static constexpr Count max_count = std::numeric_limits<Count>::max();
+
+  std::vector<T> m_values;
+  std::vector<std::pair<T, Count>> m_mins;
+  Compare m_cmp{};
+};
+
+/**
+ * @brief Stack Min for integral values, storing one delta per value.
+ *
+ * Each slot holds the difference between the pushed value and the minimum just before the push,
+ * in a signed type D wide enough for any difference of two T values. A negative delta marks a push
+ * that lowered the minimum, and lets pop restore the previous minimum (old min = new min - delta).
+ * So a single array and a single scalar are all the state there is, regardless of the input order,
+ * at the cost of D being wider than T (e.g. 8 bytes per 32-bit value).
+ * Time complexity: O(1) per operation (amortized for push).
+ * Space complexity: O(N).
+ */
+template <typename T, typename D = std::conditional_t<sizeof(T) <= 2, std::int32_t, std::int64_t>>
+class DeltaMinStack
+{
+  static_assert(std::is_integral_v<T> && std::is_integral_v<D> && std::is_signed_v<D>,
+                "DeltaMinStack requires integral values and a signed delta type");
+  static_assert(sizeof(T) < sizeof(D), "delta type must be wider than the value type");
+
+public:
+
+  DeltaMinStack() = default;
+
+  void push(T const val)
+  {
+    if (m_deltas.empty())
+    {
+      m_deltas.push_back(0);
+      m_min = val;
+      return;
+    }
+    D const delta = static_cast<D>(val) - static_cast<D>(m_min);
+    m_deltas.push_back(delta);
+    if (delta < 0) m_min = val;
+  }
+
+  [[nodiscard]]
+  T peek() const
+  {
+    assert(!empty());
+    D const delta = m_deltas.back();
+    return delta < 0 ? m_min : static_cast<T>(m_min + delta);
+  }
+
+  [[nodiscard]]
+  T min() const
+  {
+    assert(!empty());
+    return m_min;
+  }
+
+  void pop()
+  {
+    assert(!empty());
+    D const delta = m_deltas.back();
+    m_deltas.pop_back();
+    if (delta < 0) m_min = static_cast<T>(m_min - delta);
+  }
+
+  [[nodiscard]]
+  bool empty() const
+  {
+    return m_deltas.empty();
+  }
+
+  [[nodiscard]]
+  size_t size() const
+  {
+    return m_deltas.size();
+  }
+
+  [[nodiscard]]
+  size_t memory_usage() const
+  {
+    return m_deltas.capacity() * sizeof(D);
+  }
+
+private:
+
+  std::vector<D> m_deltas;
+  T m_min{};
+};
+
+/**
+ * @brief FIFO queue with O(1) min and max (monotonic deques).
+ *
+ * Besides the values themselves, keeps a deque of candidate minima in non-decreasing order
+ * and a deque of candidate maxima in non-increasing order. A pushed value evicts from the back
+ * every candidate it beats, since that candidate will leave the queue before it; a popped value
+ * leaves the candidate deques only if it is at their front. Equal values are all kept as candidates,
+ * so popping one of them never loses the extremum.
+ * Time complexity: O(1) amortized per operation.
+ * Space complexity: O(N).
+ */
+template <typename T>
+class MinMaxQueue
+{
+public:
+
+  MinMaxQueue() = default;
+
+  void push(T const & val)
+  {
+    m_values.push_back(val);
+    while (!m_mins.empty() && val < m_mins.back()) m_mins.pop_back();
+    m_mins.push_back(val);
+    while (!m_maxs.empty() && m_maxs.back() < val) m_maxs.pop_back();
+    m_maxs.push_back(val);
+  }
+
+  template <typename It>
+  void push_range(It first, It last)
+  {
+    for (; first != last; ++first) push(*first);
+  }
+
+  void pop()
+  {
+    assert(!empty());
+    T const & val = m_values.front();
+    if (!(m_mins.front() < val)) m_mins.pop_front();
+    if (!(val < m_maxs.front())) m_maxs.pop_front();
+    m_values.pop_front();
+  }
+
+  void pop_n(size_t n)
+  {
+    assert(n <= size());
+    for (; n > 0; --n) pop();
+  }
+
+  [[nodiscard]]
+  T const & front() const
+  {
+    assert(!empty());
+    return m_values.front();
+  }
+
+  [[nodiscard]]
+  T const & min() const
+  {
+    assert(!empty());
+    return m_mins.front();
+  }
+
+  [[nodiscard]]
+  T const & max() const
+  {
+    assert(!empty());
+    return m_maxs.front();
   }
 
   [[nodiscard]]
@@ -56,13 +268,233 @@ public:
 
 private:
 
-  std::stack<T, std::vector<T>> m_values;
-  std::stack<T, std::vector<T>> m_mins;
+  std::deque<T> m_values;
+  std::deque<T> m_mins;
+  std::deque<T> m_maxs;
+};
+
+/**
+ * @brief FIFO queue with O(1) min, built from two MinStacks.
+ *
+ * Values are pushed onto the back stack and popped from the front stack; when the front stack
+ * runs dry the back stack is poured into it, reversing the order. The queue minimum is the lesser
+ * of the two stack minima. Compare selects the extremum, as for MinStack.
+ * Time complexity: O(1) amortized per operation.
+ * Space complexity: O(N).
+ */
+template <typename T, typename Compare = std::less<T>>
+class MinQueue
+{
+public:
+
+  MinQueue() = default;
+
+  void push(T const & val)
+  {
+    m_back.push(val);
+  }
+
+  template <typename It>
+  void push_range(It first, It last)
+  {
+    for (; first != last; ++first) m_back.push(*first);
+  }
+
+  void pop()
+  {
+    assert(!empty());
+    if (m_front.empty()) transfer();
+    m_front.pop();
+  }
+
+  /**
+   * @brief Pop n values, pouring the back stack over at most once per exhausted front stack.
+   */
+  void pop_n(size_t n)
+  {
+    assert(n <= size());
+    while (n > 0)
+    {
+      if (m_front.empty()) transfer();
+      for (; n > 0 && !m_front.empty(); --n) m_front.pop();
+    }
+  }
+
+  [[nodiscard]]
+  T const & min() const
+  {
+    assert(!empty());
+    if (m_front.empty()) return m_back.min();
+    if (m_back.empty()) return m_front.min();
+    return m_cmp(m_back.min(), m_front.min()) ? m_back.min() : m_front.min();
+  }
+
+  [[nodiscard]]
+  bool empty() const
+  {
+    return m_front.empty() && m_back.empty();
+  }
+
+  [[nodiscard]]
+  size_t size() const
+  {
+    return m_front.size() + m_back.size();
+  }
+
+private:
+
+  void transfer()
+  {
+    while (!m_back.empty())
+    {
+      m_front.push(m_back.peek());
+      m_back.pop();
+    }
+  }
+
+  MinStack<T, Compare> m_front;
+  MinStack<T, Compare> m_back;
+  Compare m_cmp{};
 };
 
-int main()
+/**
+ * @brief Minimum of every window of w consecutive values of in[0..n), written to out[0..n-w+1).
+ *
+ * Uses the van Herk/Gil-Werman scheme instead of a deque: the input is cut into blocks of w values,
+ * and the window starting at i spans the tail of one block and the head of the next, so its minimum
+ * is min(suffix minimum of the first block at i, prefix minimum of the next block at i+w-1).
+ * Suffix minima of one block are kept in a w-element buffer while the prefix of the next block
+ * is scanned, so the input is streamed once, with about three comparisons per value and
+ * no data-dependent branches, regardless of the input order or w.
+ * Compare selects the extremum (std::greater<T> for window maxima).
+ * Time complexity: O(N).
+ * Space complexity: O(w).
+ */
+template <typename T, typename Compare = std::less<T>>
+void sliding_window_min(T const * in, size_t n, size_t w, T * out, Compare cmp = {})
+{
+  assert(w > 0);
+  if (n < w) return;
+  auto const pick = [&cmp](T const & a, T const & b) -> T const & { return cmp(b, a) ? b : a; };
+
+  std::vector<T> suffix(w);
+  for (size_t b = 0; b + w <= n; b += w)
+  {
+    // suffix minima of block [b, b + w)
+    suffix[w - 1] = in[b + w - 1];
+    for (size_t i = w - 1; i > 0; --i) suffix[i - 1] = pick(in[b + i - 1], suffix[i]);
+
+    // the window starting at i = b spans the block; the one starting at i > b ends at j = i + w - 1 in the next block
+    out[b] = suffix[0];
+    size_t const end = std::min(n, b + 2 * w - 1);
+    T prefix = b + w < end ? in[b + w] : suffix[0];
+    for (size_t j = b + w; j < end; ++j)
+    {
+      prefix = pick(prefix, in[j]);
+      out[j - w + 1] = pick(suffix[j - w + 1 - b], prefix);
+    }
+  }
+}
+
+/**
+ * Apply random pushes and pops to a stack and check it against a plain vector.
+ */
+template <typename Stack, typename Compare = std::less<int>>
+void test_random(int lo, int hi, unsigned seed)
+{
+  std::mt19937 gen(seed);
+  std::uniform_int_distribution<int> val(lo, hi);
+  Stack s;
+  std::vector<int> ref;
+  for (int i = 0; i < 20000; ++i)
+  {
+    if (ref.empty() || gen() % 3 != 0)
+    {
+      int const v = val(gen);
+      s.push(v);
+      ref.push_back(v);
+    }
+    else
+    {
+      s.pop();
+      ref.pop_back();
+    }
+    assert(s.size() == ref.size());
+    assert(s.empty() == ref.empty());
+    if (!ref.empty())
+    {
+      assert(s.peek() == ref.back());
+      assert(s.min() == *std::min_element(ref.begin(), ref.end(), Compare{}));
+    }
+  }
+}
+
+/**
+ * Apply random batches of pushes and pops to both queues and check them against a plain deque.
+ */
+void test_queues(unsigned seed)
+{
+  std::mt19937 gen(seed);
+  MinMaxQueue<int> q;
+  MinQueue<int> qmin;
+  MinQueue<int, std::greater<int>> qmax;
+  std::deque<int> ref;
+  std::vector<int> batch;
+  for (int i = 0; i < 5000; ++i)
+  {
+    if (ref.empty() || gen() % 2 == 0)
+    {
+      batch.resize(gen() % 8);
+      for (auto & v : batch) v = static_cast<int>(gen() % 100);
+      q.push_range(batch.begin(), batch.end());
+      qmin.push_range(batch.begin(), batch.end());
+      qmax.push_range(batch.begin(), batch.end());
+      ref.insert(ref.end(), batch.begin(), batch.end());
+    }
+    else
+    {
+      size_t const n = gen() % (ref.size() + 1);
+      q.pop_n(n);
+      qmin.pop_n(n);
+      qmax.pop_n(n);
+      ref.erase(ref.begin(), ref.begin() + static_cast<std::ptrdiff_t>(n));
+    }
+    assert(q.size() == ref.size() && qmin.size() == ref.size() && qmax.size() == ref.size());
+    if (!ref.empty())
+    {
+      [[maybe_unused]] int const mn = *std::min_element(ref.begin(), ref.end());
+      [[maybe_unused]] int const mx = *std::max_element(ref.begin(), ref.end());
+      assert(q.front() == ref.front());
+      assert(q.min() == mn && qmin.min() == mn);
+      assert(q.max() == mx && qmax.min() == mx);
+    }
+  }
+}
+
+/**
+ * Compare window minima and maxima with a brute-force scan of every window.
+ */
+void test_window(size_t n, size_t w, unsigned seed)
 {
-  MinStack<int> s;
+  std::mt19937 gen(seed);
+  std::vector<int> in(n);
+  for (auto & v : in) v = static_cast<int>(gen() % 50);
+
+  std::vector<int> mins(n >= w ? n - w + 1 : 0);
+  std::vector<int> maxs(mins.size());
+  sliding_window_min(in.data(), n, w, mins.data());
+  sliding_window_min(in.data(), n, w, maxs.data(), std::greater<int>{});
+  for (size_t i = 0; i < mins.size(); ++i)
+  {
+    assert(mins[i] == *std::min_element(in.begin() + i, in.begin() + i + w));
+    assert(maxs[i] == *std::max_element(in.begin() + i, in.begin() + i + w));
+  }
+}
+
+template <typename Stack>
+void test_basic()
+{
+  Stack s;
   assert(s.empty());
   s.push(5);
   assert(!s.empty());
@@ -77,6 +509,11 @@ int main()
   assert(s.size() == 3);
   assert(s.peek() == 9);
   assert(s.min() == 3);
+  s.push(3);
+  assert(s.size() == 4);
+  assert(s.min() == 3);
+  s.pop();
+  assert(s.min() == 3);
   s.pop();
   assert(s.size() == 2);
   assert(s.peek() == 3);
@@ -88,3 +525,135 @@ int main()
   s.pop();
   assert(s.empty());
 }
+
+/**
+ * Memory after pushing n values and throughput of pushing then popping them all,
+ * for ascending, descending and random input.
+ */
+template <typename Stack>
+void bench_stack(char const * name, std::vector<int> const & input, char const * order)
+{
+  Stack s;
+  for (int const v : input) s.push(v);
+  std::cout << name << " (" << order << "): "
+            << static_cast<double>(s.memory_usage()) / input.size() << " bytes/elem\n";
+
+  double const t = benchmark::measure([&]
+  {
+    Stack st;
+    for (int const v : input) st.push(v);
+    long long sum = 0;
+    while (!st.empty())
+    {
+      sum += st.min();
+      st.pop();
+    }
+    benchmark::do_not_optimize(sum);
+  });
+  benchmark::report(std::string(name) + " push+pop (" + order + ")", input.size(), t);
+}
+
+void bench()
+{
+  size_t const n = 10000000;
+  std::vector<int> input(n);
+  std::mt19937 gen(42);
+  for (char const * order : {"ascending", "descending", "random"})
+  {
+    std::string const o = order;
+    for (size_t i = 0; i < n; ++i)
+    {
+      int const k = static_cast<int>(i);
+      input[i] = o == "ascending" ? k : o == "descending" ? -k : static_cast<int>(gen());
+    }
+    bench_stack<MinStack<int>>("MinStack", input, order);
+    bench_stack<DeltaMinStack<int>>("DeltaMinStack", input, order);
+  }
+}
+
+/**
+ * Window minima of a random series, streamed through each structure.
+ */
+void bench_window()
+{
+  size_t const n = 10000000;
+  std::vector<int> input(n);
+  std::mt19937 gen(42);
+  for (auto & v : input) v = static_cast<int>(gen());
+  std::vector<int> out(n);
+
+  for (size_t const w : {16u, 1024u, 65536u})
+  {
+    std::string const suffix = " w=" + std::to_string(w);
+    benchmark::report("MinMaxQueue window" + suffix, n, benchmark::measure([&]
+    {
+      MinMaxQueue<int> q;
+      q.push_range(input.begin(), input.begin() + static_cast<std::ptrdiff_t>(w - 1));
+      for (size_t i = w - 1; i < n; ++i)
+      {
+        q.push(input[i]);
+        out[i - w + 1] = q.min();
+        q.pop();
+      }
+      benchmark::do_not_optimize(out.data());
+    }));
+    benchmark::report("MinQueue window" + suffix, n, benchmark::measure([&]
+    {
+      MinQueue<int> q;
+      q.push_range(input.begin(), input.begin() + static_cast<std::ptrdiff_t>(w - 1));
+      for (size_t i = w - 1; i < n; ++i)
+      {
+        q.push(input[i]);
+        out[i - w + 1] = q.min();
+        q.pop();
+      }
+      benchmark::do_not_optimize(out.data());
+    }));
+    benchmark::report("sliding_window_min" + suffix, n, benchmark::measure([&]
+    {
+      sliding_window_min(input.data(), n, w, out.data());
+      benchmark::do_not_optimize(out.data());
+    }));
+  }
+}
+
+int main(int argc, char ** argv)
+{
+  test_basic<MinStack<int>>();
+  test_basic<DeltaMinStack<int>>();
+  test_basic<DeltaMinStack<short>>();
+  test_random<MinStack<int>>(0, 1000, 1);
+  test_random<MinStack<int>>(0, 3, 2);
+  test_random<MinStack<int, std::less<int>, std::uint8_t>>(0, 1, 8); // runs of the minimum overflow their count
+  test_random<DeltaMinStack<int>>(std::numeric_limits<int>::min(), std::numeric_limits<int>::max(), 3);
+  test_random<DeltaMinStack<int>>(0, 3, 4);
+  test_random<DeltaMinStack<std::int16_t>>(-32768, 32767, 5);
+  test_random<MinStack<int, std::greater<int>>, std::greater<int>>(0, 1000, 6);
+  test_random<MinStack<int, std::greater<int>>, std::greater<int>>(0, 3, 7);
+
+  test_queues(1);
+  test_queues(2);
+  for (size_t const n : {0u, 1u, 5u, 16u, 17u, 100u, 1000u})
+  {
+    for (size_t const w : {1u, 2u, 3u, 7u, 16u, 100u})
+    {
+      test_window(n, w, static_cast<unsigned>(n * 131 + w));
+    }
+  }
+
+  // equal values must not grow the run stack
+  {
+    MinStack<int> s;
+    for (int i = 0; i < 1000; ++i) s.push(7);
+    assert(s.min() == 7);
+    assert(s.memory_usage() <= 1024 * sizeof(int) + sizeof(std::pair<int, std::uint32_t>));
+    for (int i = 0; i < 999; ++i) s.pop();
+    assert(s.size() == 1 && s.min() == 7);
+  }
+
+  if (benchmark::requested(argc, argv))
+  {
+    bench();
+    bench_window();
+  }
+}
@@ -1,76 +1,617 @@
-#include <stack>
+#include "Epoch.hpp"
+
+#include "benchmark.hpp"
+
 #include <vector>
+#include <deque>
+#include <random>
+#include <string>
+#include <memory>
+#include <atomic>
+#include <thread>
+#include <optional>
+#include <algorithm>
 #include <cassert>
+#include <cstdint>
+#include <cstddef>
 
+/**
+ * @brief Stack of Plates.
+ *
+ * A stack split into plates of at most max_size values each, with pop_at(index) popping from a given plate.
+ * Plates live in a deque (stable addresses, no per-plate reallocation) and are recycled through a free list.
+ * Their order is an intrusive doubly-linked list, so an emptied plate is unlinked in O(1) wherever it is.
+ * Each plate keeps the index it was created with, and a vector maps indices to plates: removing a plate
+ * from the middle leaves a hole in that vector instead of renumbering the plates above it, and holes are
+ * dropped once nothing is above them. Each plate is a ring buffer, so its bottom value can be removed in O(1).
+ * In rollover mode, pop_at refills the hole by moving the bottom value of every later plate down one plate,
+ * keeping all plates but the top one full (so plates are only ever removed from the top and indices stay
+ * dense); otherwise plates emptied by pop_at are simply removed.
+ * Time complexity: O(1) amortized push/pop/peek/size/pop_at; in rollover mode, pop_at also moves
+ * one value per plate above the given one, which preserving the order of values requires.
+ * Space complexity: O(N + P * max_size), plus one pointer per index up to the highest one in use.
+ */
 template <typename T>
 class SetOfStacks
 {
 public:
 
-  explicit SetOfStacks(size_t max_size) : m_max_size(max_size), m_stacks{} {};
+  explicit SetOfStacks(size_t max_size, bool rollover = false) : m_max_size(max_size), m_rollover(rollover)
+  {
+    assert(max_size > 0);
+  }
 
   [[nodiscard]]
   bool empty() const
   {
-    return m_stacks.empty();
+    return m_size == 0;
   }
 
   void push(T const & val)
   {
-    if (m_stacks.empty() || m_stacks.back().size() == m_max_size)
+    if (!m_top || m_top->count == m_max_size)
     {
-      m_stacks.emplace_back();
+      Plate * const plate = new_plate();
+      plate->index = m_by_index.size();
+      plate->below = m_top;
+      if (m_top) m_top->above = plate;
+      m_top = plate;
+      m_by_index.push_back(plate);
+      ++m_plates;
     }
-    m_stacks.back().push(val);
+    m_top->push(val, m_max_size);
+    ++m_size;
   }
 
   void pop()
   {
     assert(!empty());
-    m_stacks.back().pop();
-    if (m_stacks.back().empty())
-    {
-      m_stacks.erase(m_stacks.end()-1);
-    }
+    pop_at(m_top->index);
   }
 
   [[nodiscard]]
   T const & peek() const
   {
     assert(!empty());
-    return m_stacks.back().top();
+    return m_top->top(m_max_size);
   }
 
   [[nodiscard]]
   size_t size() const
   {
-    size_t sz = 0;
-    for (auto const & s : m_stacks)
-    {
-      sz += s.size();
-    }
-    return sz;
+    return m_size;
+  }
+
+  [[nodiscard]]
+  size_t plates() const
+  {
+    return m_plates;
+  }
+
+  /**
+   * @brief One past the highest plate index in use; indices below it may be holes left by removed plates.
+   */
+  [[nodiscard]]
+  size_t index_bound() const
+  {
+    return m_by_index.size();
   }
 
+  [[nodiscard]]
+  bool has_plate(size_t index) const
+  {
+    return index < m_by_index.size() && m_by_index[index];
+  }
+
+  /**
+   * @brief Pop from the plate created with @p index, which must still exist.
+   */
   void pop_at(size_t index)
   {
-    assert(index < m_stacks.size());
-    assert(!m_stacks[index].empty());
-    m_stacks[index].pop();
-    if (m_stacks[index].empty())
+    assert(has_plate(index));
+    Plate * const plate = m_by_index[index];
+    plate->pop(m_max_size);
+    --m_size;
+
+    if (m_rollover)
     {
-      m_stacks.erase(m_stacks.begin() + index);
+      for (Plate * p = plate; p->above; p = p->above)
+      {
+        p->push(p->above->pop_bottom(m_max_size), m_max_size);
+      }
+      if (m_top->count == 0) release_plate(m_top);
+    }
+    else if (plate->count == 0)
+    {
+      release_plate(plate);
     }
   }
 
 private:
 
+  struct Plate
+  {
+    explicit Plate(size_t max_size) : vals(new T[max_size]) {}
+
+    T const & top(size_t cap) const
+    {
+      return vals[(begin + count - 1) % cap];
+    }
+
+    void push(T val, size_t cap)
+    {
+      vals[(begin + count++) % cap] = std::move(val);
+    }
+
+    void pop(size_t cap)
+    {
+      vals[(begin + --count) % cap] = T{};
+    }
+
+    T pop_bottom(size_t cap)
+    {
+      T val = std::move(vals[begin]);
+      begin = (begin + 1) % cap;
+      --count;
+      return val;
+    }
+
+    std::unique_ptr<T[]> vals;
+    size_t begin{};
+    size_t count{};
+    size_t index{};
+    Plate * below{};
+    Plate * above{};
+  };
+
+  Plate * new_plate()
+  {
+    if (m_free.empty()) return &m_storage.emplace_back(m_max_size);
+    Plate * const plate = m_free.back();
+    m_free.pop_back();
+    plate->begin = 0;
+    plate->below = nullptr;
+    plate->above = nullptr;
+    return plate;
+  }
+
+  void release_plate(Plate * const plate)
+  {
+    if (plate->below) plate->below->above = plate->above;
+    if (plate->above) plate->above->below = plate->below;
+    else m_top = plate->below;
+    m_by_index[plate->index] = nullptr;
+    while (!m_by_index.empty() && !m_by_index.back()) m_by_index.pop_back();
+    m_free.push_back(plate);
+    --m_plates;
+  }
+
   size_t m_max_size;
-  std::vector<std::stack<T, std::vector<T>>> m_stacks;
+  bool m_rollover;
+  size_t m_size{};
+  size_t m_plates{};
+  Plate * m_top{};
+  std::deque<Plate> m_storage;
+  std::vector<Plate *> m_free;
+  std::vector<Plate *> m_by_index;
+};
+
+/**
+ * @brief Concurrent stack of plates for use as a shared work pool.
+ *
+ * Each plate is a fixed-capacity array of slots with an atomic top index; plates form a chain
+ * from the top plate down, and a full top plate is covered by a new one with a single CAS on the
+ * chain head. A thread reserves a slot by moving the top index with CAS, then claims the slot itself
+ * through a per-slot state machine (EMPTY -> WRITING -> FULL on push, FULL -> READING -> EMPTY on pop),
+ * so pushes and pops that race for the same slot hand values over one at a time instead of losing them.
+ * That handoff is the only wait: a thread may briefly spin on a slot whose previous owner
+ * has not finished its copy yet.
+ * An empty top plate is sealed (a flag in its top word that stops further pushes) and unlinked;
+ * unlinked plates are freed through epoch-based reclamation, so concurrent readers never touch freed memory.
+ * The element count is a separate atomic counter, so size() is O(1).
+ *
+ * As in SetOfStacks, plate indices (counted from the bottom) are stable, but here a plate below the top
+ * that is emptied by pop_at stays in place and is unlinked only once it becomes the top plate.
+ * T must be default-constructible and move-assignable.
+ */
+template <typename T>
+class ConcurrentSetOfStacks
+{
+public:
+
+  explicit ConcurrentSetOfStacks(std::uint32_t max_size) : m_max_size(max_size)
+  {
+    assert(max_size > 0 && max_size < sealed);
+  }
+
+  ConcurrentSetOfStacks(ConcurrentSetOfStacks const &) = delete;
+  ConcurrentSetOfStacks & operator=(ConcurrentSetOfStacks const &) = delete;
+
+  ~ConcurrentSetOfStacks()
+  {
+    for (Plate * p = m_top.load(); p;)
+    {
+      Plate * const prev = p->prev;
+      delete p;
+      p = prev;
+    }
+  }
+
+  void push(T val)
+  {
+    typename Reclaim::Guard guard(m_reclaim);
+    for (;;)
+    {
+      Plate * const p = m_top.load(std::memory_order_acquire);
+      if (!p || p->full_or_sealed())
+      {
+        if (p && p->is_sealed()) unlink(p);
+        else add_plate(p);
+        continue;
+      }
+      std::uint32_t t = p->top.load();
+      if ((t & sealed) || t == m_max_size || !p->top.compare_exchange_weak(t, t + 1)) continue;
+
+      Slot & slot = p->slots[t];
+      claim(slot, slot_empty, slot_writing);
+      slot.value = std::move(val);
+      m_size.fetch_add(1);
+      slot.state.store(slot_full, std::memory_order_release);
+      return;
+    }
+  }
+
+  /**
+   * @brief Pop from the top plate, unlinking emptied plates on the way.
+   * @return the value, or nothing if the structure was empty
+   */
+  std::optional<T> try_pop()
+  {
+    typename Reclaim::Guard guard(m_reclaim);
+    for (;;)
+    {
+      Plate * const p = m_top.load(std::memory_order_acquire);
+      if (!p) return std::nullopt;
+      if (auto val = take(p)) return val;
+      // plate is empty: seal it (unless a push got in first) and move on to the one below
+      std::uint32_t t = 0;
+      if (p->top.compare_exchange_strong(t, sealed) || (t & sealed)) unlink(p);
+    }
+  }
+
+  /**
+   * @brief Pop from plate @p index, counted from the bottom.
+   * @return the value, or nothing if that plate does not exist or is empty
+   */
+  std::optional<T> try_pop_at(size_t index)
+  {
+    typename Reclaim::Guard guard(m_reclaim);
+    Plate * p = m_top.load(std::memory_order_acquire);
+    for (; p && p->index > index; p = p->prev);
+    if (!p || p->index != index) return std::nullopt;
+    return take(p);
+  }
+
+  [[nodiscard]]
+  size_t size() const
+  {
+    return m_size.load();
+  }
+
+  [[nodiscard]]
+  bool empty() const
+  {
+    return size() == 0;
+  }
+
+  ////////////////////////////////////////////////////////////////////////////////
+
+private:
 
+  static constexpr std::uint32_t sealed = 0x80000000u;
+  static constexpr std::uint8_t slot_empty = 0;
+  static constexpr std::uint8_t slot_writing = 1;
+  static constexpr std::uint8_t slot_full = 2;
+  static constexpr std::uint8_t slot_reading = 3;
+
+  struct Slot
+  {
+    std::atomic<std::uint8_t> state{slot_empty};
+    T value{};
+  };
+
+  struct Plate
+  {
+    Plate(Plate * below, std::uint32_t cap)
+    : prev(below), index(below ? below->index + 1 : 0), capacity(cap), slots(new Slot[cap]) {}
+
+    [[nodiscard]] bool is_sealed() const { return top.load() & sealed; }
+    [[nodiscard]] bool full_or_sealed() const { std::uint32_t const t = top.load(); return (t & sealed) || t == capacity; }
+
+    std::atomic<std::uint32_t> top{0};
+    Plate * const prev;
+    size_t const index;
+    std::uint32_t const capacity;
+    std::unique_ptr<Slot[]> slots;
+
+    // used by epoch reclamation once the plate is unlinked
+    Plate * retired_next{};
+    std::uint64_t retired_epoch{};
+  };
+
+  using Reclaim = epoch::Domain<Plate>;
+
+  /**
+   * @brief Wait until the slot is in state @p from and move it to @p to, excluding other claimants.
+   */
+  static void claim(Slot & slot, std::uint8_t const from, std::uint8_t const to)
+  {
+    for (std::uint8_t s = from; !slot.state.compare_exchange_weak(s, to, std::memory_order_acquire); s = from)
+    {
+      std::this_thread::yield();
+    }
+  }
+
+  /**
+   * @brief Pop one value from plate @p p, or return nothing if it is empty or sealed.
+   */
+  std::optional<T> take(Plate * p)
+  {
+    std::uint32_t t = p->top.load();
+    do
+    {
+      if (t == 0 || (t & sealed)) return std::nullopt;
+    }
+    while (!p->top.compare_exchange_weak(t, t - 1));
+
+    Slot & slot = p->slots[t - 1];
+    claim(slot, slot_full, slot_reading);
+    std::optional<T> val = std::move(slot.value);
+    m_size.fetch_sub(1);
+    slot.state.store(slot_empty, std::memory_order_release);
+    return val;
+  }
+
+  void add_plate(Plate * top)
+  {
+    Plate * const p = new Plate(top, m_max_size);
+    if (!m_top.compare_exchange_strong(top, p)) delete p;
+  }
+
+  /**
+   * @brief Remove sealed plate @p p if it is still on top; exactly one caller succeeds and retires it.
+   */
+  void unlink(Plate * p)
+  {
+    if (m_top.compare_exchange_strong(p, p->prev)) m_reclaim.retire(p);
+  }
+
+  std::uint32_t const m_max_size;
+  std::atomic<Plate *> m_top{nullptr};
+  std::atomic<size_t> m_size{0};
+  Reclaim m_reclaim;
 };
 
-int main()
+void test_rollover()
+{
+  SetOfStacks<int> s(3, true);
+  for (int i = 1; i <= 5; ++i) s.push(i);
+  s.pop_at(0);
+  assert(s.size() == 4);
+  assert(s.plates() == 2);
+  assert(s.peek() == 5);
+  s.pop_at(0);
+  assert(s.size() == 3);
+  assert(s.plates() == 1);
+  assert(s.peek() == 5);
+  s.pop();
+  assert(s.peek() == 2);
+  s.push(6);
+  s.push(7);
+  assert(s.plates() == 2);
+  s.pop_at(1);
+  assert(s.peek() == 6);
+}
+
+void test_stable_indices()
+{
+  SetOfStacks<int> s(3);
+  for (int i = 1; i <= 9; ++i) s.push(i);
+  for (int k = 0; k < 3; ++k) s.pop_at(1);
+  // plate 1 is gone, but the plate above keeps index 2
+  assert(s.plates() == 2 && s.index_bound() == 3);
+  assert(!s.has_plate(1) && s.has_plate(2));
+  s.pop_at(2);
+  assert(s.peek() == 8);
+  s.pop();
+  s.pop();
+  // the hole is dropped together with the top plate, and the next plate reuses index 1
+  assert(s.plates() == 1 && s.index_bound() == 1);
+  s.push(10);
+  s.push(11);
+  assert(s.index_bound() == 2 && s.peek() == 11);
+  s.pop_at(1);
+  assert(s.peek() == 10);
+}
+
+/**
+ * Random pushes, pops and pop_at calls checked against a vector of vectors indexed like the plates,
+ * where an empty vector is a hole left by a removed plate. In rollover mode the reference is re-packed
+ * so that only the last plate is partial.
+ */
+void test_random(size_t max_size, bool rollover, unsigned seed)
+{
+  std::mt19937 gen(seed);
+  SetOfStacks<int> s(max_size, rollover);
+  std::vector<std::vector<int>> ref;
+  size_t plates = 0;
+  for (int i = 0; i < 5000; ++i)
+  {
+    unsigned const op = gen() % 10;
+    if (ref.empty() || op < 5)
+    {
+      s.push(i);
+      if (ref.empty() || ref.back().size() == max_size)
+      {
+        ref.emplace_back();
+        ++plates;
+      }
+      ref.back().push_back(i);
+    }
+    else
+    {
+      size_t index = ref.size() - 1;
+      if (op >= 8)
+      {
+        do index = gen() % ref.size(); while (ref[index].empty());
+      }
+      assert(s.has_plate(index));
+      s.pop_at(index);
+      ref[index].pop_back();
+      if (rollover)
+      {
+        std::vector<int> flat;
+        for (auto const & plate : ref) flat.insert(flat.end(), plate.begin(), plate.end());
+        ref.clear();
+        for (size_t k = 0; k < flat.size(); k += max_size)
+        {
+          ref.emplace_back(flat.begin() + static_cast<std::ptrdiff_t>(k),
+                           flat.begin() + static_cast<std::ptrdiff_t>(std::min(flat.size(), k + max_size)));
+        }
+        plates = ref.size();
+      }
+      else if (ref[index].empty())
+      {
+        --plates;
+        while (!ref.empty() && ref.back().empty()) ref.pop_back();
+      }
+    }
+    assert(s.plates() == plates);
+    assert(s.index_bound() == ref.size());
+    assert(s.empty() == ref.empty());
+    if (!ref.empty()) assert(s.peek() == ref.back().back());
+  }
+}
+
+/**
+ * Mixed workload on a pre-filled structure: half pushes, 30% pops, 20% pop_at on a random plate.
+ */
+void bench()
+{
+  size_t const prefill = 100000;
+  size_t const ops = 200000;
+  for (size_t const max_size : {16u, 256u})
+  {
+    for (bool const rollover : {false, true})
+    {
+      std::mt19937 gen(42);
+      std::vector<unsigned> script(ops);
+      for (auto & v : script) v = static_cast<unsigned>(gen());
+
+      SetOfStacks<int> s(max_size, rollover);
+      for (size_t i = 0; i < prefill; ++i) s.push(static_cast<int>(i));
+      benchmark::Timer t;
+      for (unsigned const r : script)
+      {
+        unsigned const op = r % 10;
+        if (op < 5) s.push(static_cast<int>(r));
+        else if (op < 8) s.pop();
+        else
+        {
+          size_t const index = (r >> 8) % s.index_bound();
+          if (s.has_plate(index)) s.pop_at(index);
+          else s.pop();
+        }
+      }
+      double const seconds = t.seconds();
+      benchmark::do_not_optimize(s.size());
+      benchmark::report(std::string("SetOfStacks mixed cap=") + std::to_string(max_size)
+                        + (rollover ? " rollover" : ""), ops, seconds);
+      std::cout << "  plates: " << s.plates() << " for " << s.size() << " values\n";
+    }
+  }
+}
+
+void test_concurrent_basic()
+{
+  ConcurrentSetOfStacks<int> s(3);
+  assert(s.empty());
+  auto v = s.try_pop();
+  assert(!v);
+  for (int i = 1; i <= 5; ++i) s.push(i);
+  assert(s.size() == 5);
+  v = s.try_pop();
+  assert(v && *v == 5);
+  v = s.try_pop_at(0);
+  assert(v && *v == 3);
+  assert(s.size() == 3);
+  v = s.try_pop_at(2);
+  assert(!v);
+  v = s.try_pop_at(1);
+  assert(v && *v == 4);
+  // plate 1 is empty but stays in place until it is the top plate
+  v = s.try_pop_at(1);
+  assert(!v);
+  v = s.try_pop();
+  assert(v && *v == 2);
+  v = s.try_pop();
+  assert(v && *v == 1);
+  v = s.try_pop();
+  assert(!v);
+  assert(s.empty());
+  s.push(6);
+  v = s.try_pop_at(0);
+  assert(v && *v == 6);
+  assert(s.empty());
+}
+
+/**
+ * Producers push disjoint ranges of values while consumers pop (from the top or from random plates)
+ * until everything has been consumed; every value must come out exactly once.
+ */
+void test_concurrent_stress(unsigned num_producers, unsigned num_consumers, std::uint32_t plate_size)
+{
+  int const per_producer = 20000;
+  int const total = per_producer * static_cast<int>(num_producers);
+  ConcurrentSetOfStacks<int> s(plate_size);
+  std::vector<std::atomic<int>> seen(static_cast<size_t>(total));
+  std::atomic<int> consumed{0};
+
+  std::vector<std::thread> threads;
+  for (unsigned p = 0; p < num_producers; ++p)
+  {
+    threads.emplace_back([&, p]
+    {
+      for (int i = 0; i < per_producer; ++i) s.push(static_cast<int>(p) * per_producer + i);
+    });
+  }
+  for (unsigned c = 0; c < num_consumers; ++c)
+  {
+    threads.emplace_back([&, c]
+    {
+      size_t k = c;
+      while (consumed.load() < total)
+      {
+        auto const v = (++k % 4 == 0) ? s.try_pop_at(k % 8) : s.try_pop();
+        if (!v)
+        {
+          std::this_thread::yield();
+          continue;
+        }
+        seen[static_cast<size_t>(*v)].fetch_add(1);
+        consumed.fetch_add(1);
+      }
+    });
+  }
+  for (auto & t : threads) t.join();
+
+  assert(s.empty());
+  [[maybe_unused]] auto const left = s.try_pop();
+  assert(!left);
+  assert(std::all_of(seen.begin(), seen.end(), [](auto const & n) { return n.load() == 1; }));
+}
+
+int main(int argc, char ** argv)
 {
   SetOfStacks<int> s(3);
   assert(s.empty());
@@ -100,4 +641,18 @@ int main()
   assert(s.peek() == 1);
   s.pop_at(0);
   assert(s.empty());
+
+  test_rollover();
+  test_stable_indices();
+  test_random(1, false, 1);
+  test_random(3, false, 2);
+  test_random(3, true, 3);
+  test_random(8, true, 4);
+
+  test_concurrent_basic();
+  test_concurrent_stress(1, 1, 4);
+  test_concurrent_stress(4, 4, 2);
+  test_concurrent_stress(2, 6, 64);
+
+  if (benchmark::requested(argc, argv)) bench();
 }
@@ -1,32 +1,44 @@
+#include "RingQueue.hpp"
+#include "ConcurrentQueue.hpp"
+#include "benchmark.hpp"
+
 #include <stack>
+#include <queue>
 #include <vector>
+#include <random>
+#include <string>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstdint>
 #include <cassert>
 
+/**
+ * @brief Queue via Stacks.
+ *
+ * New values are pushed onto the add stack; removals pop from the remove stack, which is refilled
+ * (reversing the add stack into it) only when it runs empty. Values are never transferred back,
+ * so each value is moved at most once and any mix of add/remove is amortized O(1).
+ * Time complexity: O(1) amortized per operation.
+ * Space complexity: O(N).
+ */
 template <typename T>
 class MyQueue
 {
 public:
 
-  MyQueue() : m_rem_stack{}, m_add_stack{}, m_adding{true} { };
+  MyQueue() : m_rem_stack{}, m_add_stack{} { };
 
   void add(T const & val)
   {
-    if (!m_adding)
-    {
-      reverse_stack(m_rem_stack, m_add_stack);
-      m_adding = true;
-    }
     m_add_stack.push(val);
   }
 
   void remove()
   {
     assert(!empty());
-    if (m_adding)
-    {
-      reverse_stack(m_add_stack, m_rem_stack);
-      m_adding = false;
-    }
+    refill();
     m_rem_stack.pop();
   }
 
@@ -34,18 +46,20 @@ public:
   T const & peek() const
   {
     assert(!empty());
-    if (m_adding)
-    {
-      reverse_stack(m_add_stack, m_rem_stack);
-      m_adding = false;
-    }
+    refill();
     return m_rem_stack.top();
   }
 
   [[nodiscard]]
   bool empty() const
   {
-    return m_adding ? m_add_stack.empty() : m_rem_stack.empty();
+    return m_add_stack.empty() && m_rem_stack.empty();
+  }
+
+  [[nodiscard]]
+  size_t size() const
+  {
+    return m_add_stack.size() + m_rem_stack.size();
   }
 
 private:
@@ -61,15 +75,23 @@ private:
     }
   }
 
+  void refill() const
+  {
+    if (m_rem_stack.empty()) reverse_stack(m_add_stack, m_rem_stack);
+  }
+
   mutable stack_type m_rem_stack;
   mutable stack_type m_add_stack;
-  mutable bool m_adding;
 
 };
 
-int main()
+/**
+ * Basic add/remove/peek sequence, shared by every queue that offers MyQueue's interface.
+ */
+template <typename Queue>
+void test_basic()
 {
-  MyQueue<int> q;
+  Queue q;
   assert(q.empty());
   q.add(1);
   assert(!q.empty());
@@ -82,4 +104,321 @@ int main()
   assert(q.peek() == 2);
   q.remove();
   assert(q.empty());
+
+  // interleaved adds and removes keep FIFO order
+  q.add(3);
+  q.add(4);
+  q.remove();
+  q.add(5);
+  assert(q.peek() == 4);
+  q.remove();
+  assert(q.peek() == 5);
+  assert(q.size() == 1);
+}
+
+/**
+ * Random adds and removes checked against std::queue.
+ */
+template <typename Queue, typename Add, typename Remove, typename Front>
+void test_random(Add add, Remove remove, [[maybe_unused]] Front front, unsigned seed)
+{
+  std::mt19937 gen(seed);
+  Queue q;
+  std::queue<int> ref;
+  for (int i = 0; i < 10000; ++i)
+  {
+    if (ref.empty() || gen() % 5 < 3)
+    {
+      add(q, i);
+      ref.push(i);
+    }
+    else
+    {
+      remove(q);
+      ref.pop();
+    }
+    assert(q.empty() == ref.empty());
+    assert(q.size() == ref.size());
+    if (!ref.empty()) assert(front(q) == ref.front());
+  }
+}
+
+/**
+ * Three access patterns over n operations for a queue type given by its add/remove/front operations:
+ *  - alternating: one add then one remove, around a small resident size;
+ *  - bursty: bursts of adds followed by equally long bursts of removes;
+ *  - steady: a large resident queue with one add and one remove per step.
+ */
+template <typename Queue, typename Add, typename Remove, typename Front>
+void bench_queue(std::string const & name, Add add, Remove remove, Front front)
+{
+  size_t const n = 10000000;
+  benchmark::report(name + " alternating", n, benchmark::measure([&]
+  {
+    Queue q;
+    add(q, 0);
+    long long sum = 0;
+    for (size_t i = 0; i < n; ++i)
+    {
+      add(q, static_cast<int>(i));
+      sum += front(q);
+      remove(q);
+    }
+    benchmark::do_not_optimize(sum);
+  }));
+  benchmark::report(name + " bursty", n, benchmark::measure([&]
+  {
+    Queue q;
+    long long sum = 0;
+    size_t const burst = 1000;
+    for (size_t i = 0; i < n; i += 2 * burst)
+    {
+      for (size_t k = 0; k < burst; ++k) add(q, static_cast<int>(k));
+      for (size_t k = 0; k < burst; ++k)
+      {
+        sum += front(q);
+        remove(q);
+      }
+    }
+    benchmark::do_not_optimize(sum);
+  }));
+  benchmark::report(name + " steady", n, benchmark::measure([&]
+  {
+    Queue q;
+    for (int k = 0; k < 100000; ++k) add(q, k);
+    long long sum = 0;
+    for (size_t i = 0; i < n; ++i)
+    {
+      add(q, static_cast<int>(i));
+      sum += front(q);
+      remove(q);
+    }
+    benchmark::do_not_optimize(sum);
+  }));
+}
+
+/**
+ * One producer pushes 0..n-1 (singly and in batches), one consumer pops (singly and in batches)
+ * and checks that values arrive complete and in order.
+ */
+template <typename Queue>
+void test_fifo_two_threads(size_t capacity)
+{
+  std::uint64_t const n = 20000;
+  Queue q(capacity);
+  std::thread producer([&]
+  {
+    std::vector<std::uint64_t> batch;
+    for (std::uint64_t i = 0; i < n;)
+    {
+      if (i % 3 == 0)
+      {
+        batch.clear();
+        for (std::uint64_t k = i; k < std::min(n, i + 7); ++k) batch.push_back(k);
+        i += q.try_push_n(batch.begin(), batch.size());
+      }
+      else if (q.try_push(i))
+      {
+        ++i;
+      }
+      else
+      {
+        std::this_thread::yield();
+      }
+    }
+  });
+  std::vector<std::uint64_t> out(5);
+  for (std::uint64_t expected = 0; expected < n;)
+  {
+    size_t const k = expected % 2 ? q.try_pop_n(out.begin(), out.size()) : q.try_pop(out[0]);
+    if (k == 0) std::this_thread::yield();
+    for (size_t i = 0; i < k; ++i, ++expected) assert(out[i] == expected);
+  }
+  producer.join();
+  assert(q.size() == 0);
+}
+
+/**
+ * Several producers push (producer, sequence) pairs while several consumers pop them.
+ * Every value must be consumed exactly once, and each consumer must see each producer's values in order.
+ */
+void test_mpmc(unsigned num_producers, unsigned num_consumers, size_t capacity, size_t batch)
+{
+  std::uint64_t const per_producer = 5000;
+  MpmcQueue<std::uint64_t> q(capacity);
+  std::atomic<std::uint64_t> consumed{0};
+  std::uint64_t const total = per_producer * num_producers;
+  std::vector<std::atomic<int>> seen(total);
+
+  std::vector<std::thread> threads;
+  for (unsigned p = 0; p < num_producers; ++p)
+  {
+    threads.emplace_back([&, p]
+    {
+      std::vector<std::uint64_t> items;
+      for (std::uint64_t i = 0; i < per_producer;)
+      {
+        items.clear();
+        for (std::uint64_t k = i; k < std::min(per_producer, i + batch); ++k) items.push_back(std::uint64_t{p} << 32 | k);
+        size_t const k = batch > 1 ? q.try_push_n(items.begin(), items.size()) : q.try_push(items[0]);
+        if (k == 0) std::this_thread::yield();
+        i += k;
+      }
+    });
+  }
+  for (unsigned c = 0; c < num_consumers; ++c)
+  {
+    threads.emplace_back([&]
+    {
+      std::vector<std::int64_t> last(num_producers, -1);
+      std::vector<std::uint64_t> out(batch);
+      while (consumed.load() < total)
+      {
+        size_t const k = batch > 1 ? q.try_pop_n(out.begin(), out.size()) : q.try_pop(out[0]);
+        if (k == 0) std::this_thread::yield();
+        for (size_t i = 0; i < k; ++i)
+        {
+          std::uint64_t const p = out[i] >> 32;
+          std::int64_t const seq = static_cast<std::int64_t>(out[i] & 0xffffffff);
+          assert(seq > last[p]);
+          last[p] = seq;
+          seen[p * per_producer + static_cast<std::uint64_t>(seq)].fetch_add(1);
+        }
+        consumed.fetch_add(k);
+      }
+    });
+  }
+  for (auto & t : threads) t.join();
+  assert(std::all_of(seen.begin(), seen.end(), [](auto const & n) { return n.load() == 1; }));
+  assert(q.size() == 0);
+}
+
+/**
+ * Throughput and latency of passing items from producer threads to consumer threads.
+ * Every 64th item carries its enqueue timestamp; consumers record the delay until dequeue.
+ */
+template <typename Queue>
+void bench_pipeline(std::string const & name, unsigned num_producers, unsigned num_consumers, size_t batch)
+{
+  using clock = std::chrono::steady_clock;
+  std::uint64_t const per_producer = 2000000;
+  std::uint64_t const total = per_producer * num_producers;
+  Queue q(4096);
+  std::atomic<std::uint64_t> consumed{0};
+  std::vector<std::vector<std::int64_t>> latencies(num_consumers);
+
+  benchmark::Timer timer;
+  std::vector<std::thread> threads;
+  for (unsigned p = 0; p < num_producers; ++p)
+  {
+    threads.emplace_back([&]
+    {
+      std::vector<std::int64_t> items(batch);
+      for (std::uint64_t i = 0; i < per_producer;)
+      {
+        size_t const n = static_cast<size_t>(std::min<std::uint64_t>(batch, per_producer - i));
+        for (size_t k = 0; k < n; ++k)
+        {
+          items[k] = (i + k) % 64 == 0 ? clock::now().time_since_epoch().count() : 0;
+        }
+        size_t const k = q.try_push_n(items.begin(), n);
+        if (k == 0) std::this_thread::yield();
+        i += k;
+      }
+    });
+  }
+  for (unsigned c = 0; c < num_consumers; ++c)
+  {
+    threads.emplace_back([&, c]
+    {
+      std::vector<std::int64_t> out(batch);
+      while (consumed.load(std::memory_order_relaxed) < total)
+      {
+        size_t const k = q.try_pop_n(out.begin(), batch);
+        if (k == 0)
+        {
+          std::this_thread::yield();
+          continue;
+        }
+        std::int64_t const now = clock::now().time_since_epoch().count();
+        for (size_t i = 0; i < k; ++i)
+        {
+          if (out[i] != 0) latencies[c].push_back(now - out[i]);
+        }
+        consumed.fetch_add(k, std::memory_order_relaxed);
+      }
+    });
+  }
+  for (auto & t : threads) t.join();
+  double const seconds = timer.seconds();
+
+  std::vector<std::int64_t> all;
+  for (auto const & l : latencies) all.insert(all.end(), l.begin(), l.end());
+  std::sort(all.begin(), all.end());
+  benchmark::report(name + " " + std::to_string(num_producers) + "p/" + std::to_string(num_consumers)
+                    + "c batch=" + std::to_string(batch), total, seconds);
+  if (!all.empty())
+  {
+    std::cout << "  latency p50 " << all[all.size() / 2] << " ns, p99 " << all[all.size() * 99 / 100] << " ns\n";
+  }
+}
+
+/**
+ * Run with "--bench [producers consumers]" to choose the MPMC thread counts (default: 1/1, 2/2, 4/4).
+ */
+void bench_concurrent(int argc, char ** argv)
+{
+  std::vector<std::pair<unsigned, unsigned>> configs = { {1, 1}, {2, 2}, {4, 4} };
+  if (argc > 3) configs = { { static_cast<unsigned>(std::atoi(argv[2])), static_cast<unsigned>(std::atoi(argv[3])) } };
+  for (size_t const batch : {1u, 32u})
+  {
+    bench_pipeline<SpscQueue<std::int64_t>>("SpscQueue", 1, 1, batch);
+    for (auto const & [p, c] : configs) bench_pipeline<MpmcQueue<std::int64_t>>("MpmcQueue", p, c, batch);
+  }
+}
+
+void bench()
+{
+  bench_queue<MyQueue<int>>("MyQueue",
+    [](auto & q, int v) { q.add(v); }, [](auto & q) { q.remove(); }, [](auto & q) { return q.peek(); });
+  bench_queue<RingQueue<int>>("RingQueue",
+    [](auto & q, int v) { q.push(v); }, [](auto & q) { q.pop(); }, [](auto & q) { return q.front(); });
+  bench_queue<std::queue<int>>("std::queue",
+    [](auto & q, int v) { q.push(v); }, [](auto & q) { q.pop(); }, [](auto & q) { return q.front(); });
+}
+
+int main(int argc, char ** argv)
+{
+  test_basic<MyQueue<int>>();
+  test_basic<RingQueue<int>>();
+
+  test_random<MyQueue<int>>(
+    [](auto & q, int v) { q.add(v); }, [](auto & q) { q.remove(); }, [](auto & q) { return q.peek(); }, 1);
+  test_random<RingQueue<int>>(
+    [](auto & q, int v) { q.add(v); }, [](auto & q) { q.remove(); }, [](auto & q) { return q.peek(); }, 2);
+  {
+    RingQueue<int> r(5);
+    assert(r.capacity() == 8);
+    for (int i = 0; i < 20; ++i)
+    {
+      r.push(i);
+      if (i % 2) r.pop();
+    }
+    assert(r.size() == 10);
+    assert(r.front() == 10 && r.back() == 19 && r[3] == 13);
+  }
+
+  test_fifo_two_threads<SpscQueue<std::uint64_t>>(16);
+  test_fifo_two_threads<SpscQueue<std::uint64_t>>(1024);
+  test_fifo_two_threads<MpmcQueue<std::uint64_t>>(16);
+  test_mpmc(1, 1, 8, 1);
+  test_mpmc(3, 3, 64, 1);
+  test_mpmc(4, 2, 64, 8);
+  test_mpmc(2, 4, 1024, 32);
+
+  if (benchmark::requested(argc, argv))
+  {
+    bench();
+    bench_concurrent(argc, argv);
+  }
 }
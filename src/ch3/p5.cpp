@@ -1,7 +1,16 @@
+#include "SpillStack.hpp"
+#include "benchmark.hpp"
+
 #include <stack>
 #include <vector>
+#include <random>
+#include <string>
+#include <cstdlib>
 #include <cassert>
 #include <algorithm>
+#include <functional>
+#include <utility>
+#include <queue>
 
 template <typename T, template <typename U> typename Container>
 void reverse_stack(std::stack<T, Container<T>> & src,
@@ -52,12 +61,331 @@ void sort_stack(std::stack<T, Container<T>> & s)
   }
 }
 
+namespace impl
+{
+
+/**
+ * @brief A stack of sorted runs, with run lengths (bottom to top) tracked on the side.
+ */
+template <typename S>
+struct RunStack
+{
+  S * stack;
+  std::vector<size_t> runs;
+};
+
+template <typename S>
+void move_n(S & src, S & dst, size_t n)
+{
+  for (; n > 0; --n)
+  {
+    dst.emplace(std::move(src.top()));
+    src.pop();
+  }
+}
+
+/**
+ * @brief Merge the top runs of @p x and @p y onto @p out.
+ *
+ * With @p ascending, both runs yield ascending values when popped, so the smaller top is taken each time
+ * and the merged run yields descending values when popped from @p out; otherwise the opposite.
+ */
+template <typename S>
+void merge_top_runs(RunStack<S> & x, RunStack<S> & y, S & out, bool const ascending)
+{
+  size_t a = x.runs.back();
+  size_t b = y.runs.back();
+  x.runs.pop_back();
+  y.runs.pop_back();
+  while (a > 0 && b > 0)
+  {
+    bool const take_x = ascending ? !(y.stack->top() < x.stack->top()) : !(x.stack->top() < y.stack->top());
+    S & src = take_x ? *x.stack : *y.stack;
+    out.emplace(std::move(src.top()));
+    src.pop();
+    --(take_x ? a : b);
+  }
+  move_n(*x.stack, out, a);
+  move_n(*y.stack, out, b);
+}
+
+}
+
+/**
+ * @brief Sort Stack, in O(N log N) with four auxiliary stacks.
+ *
+ * Sorts so that the smallest value ends up on top, like sort_stack, but by balanced merging of sorted runs:
+ *  - the stack is poured into an auxiliary stack while natural runs (maximal non-decreasing or
+ *    strictly decreasing stretches) are detected; if there is just one run, the stack was already
+ *    sorted (or reverse-sorted) and is restored in O(N);
+ *  - runs are dealt alternately onto two stacks, each reversed (via a spare stack) if needed so that
+ *    all runs have the same orientation;
+ *  - passes merge pairs of runs from two stacks onto two others, halving the number of runs and flipping
+ *    their orientation; the initial orientation is chosen so that the final pass can merge straight into
+ *    the original stack with the smallest value on top.
+ * Values only ever move between stacks; run lengths are tracked in side arrays of O(R) counts.
+ * Time complexity: O(N log R), where R <= N is the number of natural runs.
+ * Space complexity: O(N).
+ */
+template <typename T, template <typename U> class Container>
+void sort_stack_merge(std::stack<T, Container<T>> & s)
+{
+  using S = std::stack<T, Container<T>>;
+  using impl::RunStack;
+  using impl::move_n;
+
+  if (s.size() < 2) return;
+
+  // Pour s into a while recording natural runs in popping order (true = non-decreasing)
+  S a, b, c, d;
+  std::vector<std::pair<size_t, bool>> natural;
+  while (!s.empty())
+  {
+    if (natural.empty())
+    {
+      natural.emplace_back(1, true);
+    }
+    else
+    {
+      auto & [len, up] = natural.back();
+      if (len == 1)
+      {
+        up = !(s.top() < a.top());
+        ++len;
+      }
+      else if (up ? !(s.top() < a.top()) : s.top() < a.top())
+      {
+        ++len;
+      }
+      else
+      {
+        natural.emplace_back(1, true);
+      }
+    }
+    a.emplace(std::move(s.top()));
+    s.pop();
+  }
+
+  // Fast path: a single run means s was sorted or reverse-sorted
+  if (natural.size() == 1)
+  {
+    if (natural.front().second)
+    {
+      move_n(a, s, a.size());
+    }
+    else
+    {
+      move_n(a, b, a.size());
+      move_n(b, s, b.size());
+    }
+    return;
+  }
+
+  // A run is "ascending" if popping it yields ascending values. Every merge pass flips the orientation,
+  // and the last one must leave s ascending, so runs start ascending iff the number of passes is even.
+  size_t passes = 0;
+  for (size_t r = natural.size(); r > 1; r = (r + 1) / 2) ++passes;
+  bool ascending = passes % 2 == 0;
+
+  // Deal runs from a onto b and c, reversing through d those that arrive with the wrong orientation
+  RunStack<S> in[2] = { { &b, {} }, { &c, {} } };
+  for (size_t k = 0; !natural.empty(); ++k)
+  {
+    auto const [len, up] = natural.back();
+    natural.pop_back();
+    RunStack<S> & dst = in[k % 2];
+    // a run popped from s in non-decreasing order pops from a in non-increasing order,
+    // so moving it directly leaves its smallest value on top, i.e. ascending
+    if (up == ascending)
+    {
+      move_n(a, *dst.stack, len);
+    }
+    else
+    {
+      move_n(a, d, len);
+      move_n(d, *dst.stack, len);
+    }
+    dst.runs.push_back(len);
+  }
+
+  // Merge passes, alternating between (b, c) -> (a, d) and back; the last pass writes into s
+  RunStack<S> out[2] = { { &a, {} }, { &d, {} } };
+  while (in[0].runs.size() + in[1].runs.size() > 1)
+  {
+    bool const last = in[0].runs.size() + in[1].runs.size() <= 2;
+    for (size_t k = 0; !in[0].runs.empty() || !in[1].runs.empty(); ++k)
+    {
+      S & dst = last ? s : *out[k % 2].stack;
+      size_t len = 0;
+      if (!in[0].runs.empty() && !in[1].runs.empty())
+      {
+        len = in[0].runs.back() + in[1].runs.back();
+        impl::merge_top_runs(in[0], in[1], dst, ascending);
+      }
+      else
+      {
+        RunStack<S> & src = in[0].runs.empty() ? in[1] : in[0];
+        len = src.runs.back();
+        src.runs.pop_back();
+        move_n(*src.stack, dst, len);
+      }
+      if (!last) out[k % 2].runs.push_back(len);
+    }
+    ascending = !ascending;
+    std::swap(in, out);
+  }
+}
+
+namespace impl
+{
+
+/**
+ * @brief A sorted (descending) run of values stored in a file, in elements.
+ */
+struct FileRun
+{
+  size_t offset;
+  size_t length;
+};
+
+/**
+ * @brief K-way merge of descending runs from @p file, feeding values to @p sink largest first.
+ *
+ * Each run is read sequentially in blocks of @p block values; a max-heap over the current
+ * head of every run picks the next value.
+ */
+template <typename T, typename Sink>
+void merge_file_runs(spill::TempFile const & file, FileRun const * runs, size_t k, size_t block, Sink && sink)
+{
+  struct Cursor
+  {
+    FileRun rest;
+    std::vector<T> buf;
+    size_t pos;
+  };
+  std::vector<Cursor> cursors(k);
+  auto const refill = [&](Cursor & c)
+  {
+    size_t const n = std::min(block, c.rest.length);
+    c.buf.resize(n);
+    file.read_at(c.rest.offset * sizeof(T), c.buf.data(), n * sizeof(T));
+    c.rest.offset += n;
+    c.rest.length -= n;
+    c.pos = 0;
+  };
+
+  auto const less = [&](size_t a, size_t b) { return cursors[a].buf[cursors[a].pos] < cursors[b].buf[cursors[b].pos]; };
+  std::priority_queue<size_t, std::vector<size_t>, decltype(less)> heap(less);
+  for (size_t i = 0; i < k; ++i)
+  {
+    cursors[i].rest = runs[i];
+    refill(cursors[i]);
+    if (!cursors[i].buf.empty()) heap.push(i);
+  }
+  while (!heap.empty())
+  {
+    size_t const i = heap.top();
+    heap.pop();
+    Cursor & c = cursors[i];
+    sink(c.buf[c.pos]);
+    if (++c.pos == c.buf.size()) refill(c);
+    if (c.pos < c.buf.size()) heap.push(i);
+  }
+}
+
+}
+
+/**
+ * @brief Sort Stack, for stacks larger than memory.
+ *
+ * Leaves the smallest value on top, like sort_stack, using about @p memory_bytes of working memory
+ * (besides the resident segments of the stack itself):
+ *  - values are popped into a buffer of that size, sorted in descending order and written to a
+ *    temporary file as one sorted run, until the stack is empty;
+ *  - runs are merged k at a time, each read sequentially in large blocks (memory_bytes split evenly
+ *    between the runs being merged and an output block), with extra merge levels through another file
+ *    only if there are too many runs to keep a block of at least 64 KiB per run;
+ *  - the last merge produces values largest first and pushes them straight back onto the stack,
+ *    so the smallest ends up on top.
+ * If everything fits into one buffer, no file is written.
+ * Time complexity: O(N log N) comparisons, O(N log_k(N / M)) sequential I/O for M = memory_bytes / sizeof(T).
+ * Space complexity: O(M) memory, O(N) disk.
+ */
+template <typename T>
+void sort_stack_external(SpillStack<T> & s, size_t memory_bytes)
+{
+  size_t const mem = std::max<size_t>(2, memory_bytes / sizeof(T));
+  size_t const min_block = std::max<size_t>(1, (size_t{64} << 10) / sizeof(T));
+  size_t const max_fanin = std::max<size_t>(3, mem / min_block) - 1; // one block is kept for output
+
+  if (s.empty()) return;
+
+  // Produce sorted runs
+  std::vector<T> buf;
+  buf.reserve(mem);
+  spill::TempFile file;
+  std::vector<impl::FileRun> runs;
+  size_t file_end = 0;
+  while (!s.empty())
+  {
+    buf.clear();
+    for (; buf.size() < mem && !s.empty(); s.pop()) buf.push_back(s.top());
+    std::sort(buf.begin(), buf.end(), std::greater<T>());
+    if (runs.empty() && s.empty())
+    {
+      for (auto const & v : buf) s.push(v);
+      return;
+    }
+    file.write_at(file_end * sizeof(T), buf.data(), buf.size() * sizeof(T));
+    runs.push_back({ file_end, buf.size() });
+    file_end += buf.size();
+  }
+  buf = std::vector<T>();
+
+  // Intermediate merge levels, until one merge can take all runs
+  while (runs.size() > max_fanin)
+  {
+    spill::TempFile next;
+    std::vector<impl::FileRun> merged;
+    std::vector<T> out;
+    size_t const block = mem / (max_fanin + 1);
+    out.reserve(block);
+    size_t out_end = 0;
+    auto const flush = [&]
+    {
+      next.write_at(out_end * sizeof(T), out.data(), out.size() * sizeof(T));
+      out_end += out.size();
+      out.clear();
+    };
+    for (size_t i = 0; i < runs.size(); i += max_fanin)
+    {
+      size_t const k = std::min(max_fanin, runs.size() - i);
+      size_t const start = out_end;
+      impl::merge_file_runs<T>(file, runs.data() + i, k, block, [&](T const & v)
+      {
+        out.push_back(v);
+        if (out.size() == block) flush();
+      });
+      flush();
+      merged.push_back({ start, out_end - start });
+    }
+    file = std::move(next);
+    runs = std::move(merged);
+  }
+
+  // Final merge straight onto the stack
+  impl::merge_file_runs<T>(file, runs.data(), runs.size(), mem / runs.size(), [&](T const & v) { s.push(v); });
+}
+
 void test(std::vector<int> input)
 {
   std::stack<int, std::vector<int>> s(input);
+  std::stack<int, std::vector<int>> sm(input);
   sort_stack(s);
+  sort_stack_merge(sm);
+  assert(s == sm);
   std::sort(begin(input), end(input));
-  for (auto v : input)
+  for ([[maybe_unused]] auto v : input)
   {
     assert(!s.empty());
     assert(s.top() == v);
@@ -66,9 +394,159 @@ void test(std::vector<int> input)
   assert(s.empty());
 }
 
-int main()
+void test_random(size_t n, int range, unsigned seed)
+{
+  std::mt19937 gen(seed);
+  std::vector<int> input(n);
+  for (auto & v : input) v = static_cast<int>(gen() % static_cast<unsigned>(range));
+  std::stack<int, std::vector<int>> s(input);
+  sort_stack_merge(s);
+  std::sort(input.begin(), input.end());
+  for ([[maybe_unused]] auto v : input)
+  {
+    assert(s.top() == v);
+    s.pop();
+  }
+  assert(s.empty());
+}
+
+/**
+ * Random pushes and pops on a stack that keeps at most two small segments in memory, checked against a vector.
+ */
+void test_spill_stack()
+{
+  // 64 ints per segment, at most 2 segments in memory
+  SpillStack<int> s(64 * sizeof(int), 2);
+  assert(s.empty());
+  std::vector<int> ref;
+  std::mt19937 gen(7);
+  for (int i = 0; i < 20000; ++i)
+  {
+    if (ref.empty() || gen() % 3 != 0)
+    {
+      s.push(i);
+      ref.push_back(i);
+    }
+    else
+    {
+      s.pop();
+      ref.pop_back();
+    }
+    assert(s.size() == ref.size());
+    assert(s.size() - s.spilled() <= 2 * 64);
+    if (!ref.empty()) assert(s.top() == ref.back());
+  }
+  assert(s.spilled() > 0);
+  while (!ref.empty())
+  {
+    assert(s.top() == ref.back());
+    s.pop();
+    ref.pop_back();
+  }
+  assert(s.empty() && s.spilled() == 0);
+
+  // no temporary file is created until something spills, so an unusable TMPDIR does not matter before that
+  char const * const tmpdir = std::getenv("TMPDIR");
+  std::string const saved = tmpdir ? tmpdir : "";
+  ::setenv("TMPDIR", "/nonexistent-ctci-dir", 1);
+  {
+    SpillStack<int> small(64 * sizeof(int), 2);
+    for (int i = 0; i < 128; ++i) small.push(i);
+    assert(small.spilled() == 0 && small.top() == 127);
+  }
+  if (tmpdir) ::setenv("TMPDIR", saved.c_str(), 1);
+  else ::unsetenv("TMPDIR");
+}
+
+void test_external(size_t n, size_t memory_bytes, unsigned seed)
+{
+  std::mt19937 gen(seed);
+  std::vector<int> input(n);
+  for (auto & v : input) v = static_cast<int>(gen() % 100000);
+  SpillStack<int> s(4096, 2);
+  for (int const v : input) s.push(v);
+  sort_stack_external(s, memory_bytes);
+  assert(s.size() == n);
+  std::sort(input.begin(), input.end());
+  for ([[maybe_unused]] auto v : input)
+  {
+    assert(s.top() == v);
+    s.pop();
+  }
+  assert(s.empty());
+}
+
+/**
+ * External sort of a stack of 10^8 ints (400 MB) with 64 MB of working memory and 16 MB resident in the stack.
+ */
+void bench_external()
+{
+  size_t const n = 100000000;
+  std::mt19937 gen(42);
+  SpillStack<int> s(size_t{4} << 20, 4);
+  for (size_t i = 0; i < n; ++i) s.push(static_cast<int>(gen()));
+  benchmark::Timer t;
+  sort_stack_external(s, size_t{64} << 20);
+  benchmark::report("sort_stack_external 64 MB", n, t.seconds());
+  benchmark::do_not_optimize(s.top());
+}
+
+/**
+ * Random, sorted and reverse-sorted stacks of 10^5..10^7 values; the quadratic sort_stack only at 10^4.
+ */
+void bench()
+{
+  std::mt19937 gen(42);
+  for (size_t const n : {10000u, 100000u, 1000000u, 10000000u})
+  {
+    std::vector<int> random(n);
+    for (auto & v : random) v = static_cast<int>(gen());
+    std::vector<int> sorted = random;
+    std::sort(sorted.begin(), sorted.end(), std::greater<int>()); // smallest value on top
+    std::vector<int> reversed(sorted.rbegin(), sorted.rend());
+
+    for (auto const & [name, input] : { std::pair<char const *, std::vector<int> const &>{ "random", random },
+                                        { "sorted", sorted }, { "reversed", reversed } })
+    {
+      using S = std::stack<int, std::vector<int>>;
+      auto const make = [&input = input] { return S(input); };
+      if (n <= 10000)
+      {
+        benchmark::report(std::string("sort_stack ") + name, n,
+                          benchmark::measure(make, [](S & s) { sort_stack(s); }, 1));
+      }
+      benchmark::report(std::string("sort_stack_merge ") + name, n,
+                        benchmark::measure(make, [](S & s) { sort_stack_merge(s); }, 3));
+    }
+  }
+}
+
+int main(int argc, char ** argv)
 {
+  test({});
+  test({1});
+  test({1,2});
+  test({2,1});
   test({1,2,3,4,5});
   test({5,3,1,4,2});
   test({5,4,3,2,1});
+  test({2,2,2,2});
+  test({3,1,3,1,3,1});
+  test({1,2,3,3,2,1,1,2,3});
+  for (size_t n = 2; n < 200; n += 7) test_random(n, 1000, static_cast<unsigned>(n));
+  test_random(100000, 1000000, 1);
+  test_random(100000, 3, 2);
+
+  test_spill_stack();
+  test_external(0, 1 << 20, 1);
+  test_external(1000, 1 << 20, 2);       // fits in memory, no runs written
+  test_external(150000, 1 << 18, 3);     // three runs, single merge
+  test_external(100000, 1 << 12, 4);     // many runs, several merge levels
+  test_external(5000, 1 << 8, 5);
+
+  if (benchmark::requested(argc, argv))
+  {
+    bench();
+    bench_external();
+  }
 }
@@ -1,7 +1,26 @@
 #include "List.hpp"
+#include "PoolList.hpp"
+#include "RingQueue.hpp"
+#include "ConcurrentQueue.hpp"
+#include "allocation.hpp"
+#include "benchmark.hpp"
 
 #include <variant>
+#include <thread>
+#include <mutex>
+#include <atomic>
 #include <string>
+#include <vector>
+#include <array>
+#include <tuple>
+#include <memory>
+#include <optional>
+#include <random>
+#include <limits>
+#include <utility>
+#include <algorithm>
+#include <type_traits>
+#include <cstdint>
 #include <cassert>
 
 struct Cat
@@ -78,9 +97,497 @@ private:
   List<node_type *> m_cats;
 };
 
-int main()
+/**
+ * @brief Same as AnimalShelter, but backed by pool lists with 32-bit index links.
+ *
+ * All three queues keep their nodes in contiguous arrays, and slots freed by
+ * dequeues are reused by later enqueues instead of going back to the heap.
+ */
+class PoolAnimalShelter
 {
-  AnimalShelter s;
+public:
+
+  PoolAnimalShelter() = default;
+
+  void enqueue(Dog dog)
+  {
+    m_dogs.add_tail(m_queue.add_tail(std::move(dog)));
+  }
+
+  void enqueue(Cat cat)
+  {
+    m_cats.add_tail(m_queue.add_tail(std::move(cat)));
+  }
+
+  std::variant<Cat, Dog> dequeueAny()
+  {
+    assert(!m_queue.empty());
+    auto animal = std::move(m_queue.vals[m_queue.head]);
+    if (std::holds_alternative<Cat>(animal)) m_cats.rem_head();
+    else m_dogs.rem_head();
+    m_queue.rem_head();
+    return animal;
+  }
+
+  Cat dequeueCat()
+  {
+    assert(!m_cats.empty());
+    auto const node = m_cats.vals[m_cats.head];
+    Cat cat = std::get<Cat>(std::move(m_queue.vals[node]));
+    m_queue.rem(node);
+    m_cats.rem_head();
+    return cat;
+  }
+
+  Dog dequeueDog()
+  {
+    assert(!m_dogs.empty());
+    auto const node = m_dogs.vals[m_dogs.head];
+    Dog dog = std::get<Dog>(std::move(m_queue.vals[node]));
+    m_queue.rem(node);
+    m_dogs.rem_head();
+    return dog;
+  }
+
+private:
+
+  using element_type = std::variant<Cat, Dog>;
+  using index_type = PoolList<element_type>::index_type;
+
+  PoolList<element_type> m_queue;
+  PoolList<index_type> m_dogs;
+  PoolList<index_type> m_cats;
+};
+
+/**
+ * @brief Same as AnimalShelter, with a single pooled node per animal.
+ *
+ * Each node holds the animal plus two sets of intrusive links: prev/next for the global arrival queue
+ * (doubly linked, since dequeueCat/dequeueDog unlink from its middle) and next_same for the queue of
+ * its own species (singly linked, since a species queue is only ever popped at its head).
+ * Any dequeue is then one node unlinked from both queues at once.
+ * Nodes come from chunks that grow geometrically and are recycled through a free list, and animals
+ * are moved in and out rather than copied, so once the pool has grown to the peak number of animals
+ * in the shelter, enqueue and dequeue perform no heap allocation.
+ */
+class IntrusiveAnimalShelter
+{
+public:
+
+  IntrusiveAnimalShelter() = default;
+
+  IntrusiveAnimalShelter(IntrusiveAnimalShelter const &) = delete;
+  IntrusiveAnimalShelter & operator=(IntrusiveAnimalShelter const &) = delete;
+
+  void enqueue(Dog && dog)
+  {
+    push(std::move(dog));
+  }
+
+  void enqueue(Cat && cat)
+  {
+    push(std::move(cat));
+  }
+
+  std::variant<Cat, Dog> dequeueAny()
+  {
+    assert(!empty());
+    return take(m_head);
+  }
+
+  Cat dequeueCat()
+  {
+    assert(m_species[cat_index].head);
+    return std::get<Cat>(take(m_species[cat_index].head));
+  }
+
+  Dog dequeueDog()
+  {
+    assert(m_species[dog_index].head);
+    return std::get<Dog>(take(m_species[dog_index].head));
+  }
+
+  [[nodiscard]]
+  bool empty() const
+  {
+    return m_head == nullptr;
+  }
+
+private:
+
+  using element_type = std::variant<Cat, Dog>;
+
+  static constexpr size_t cat_index = 0;
+  static constexpr size_t dog_index = 1;
+
+  struct Node
+  {
+    element_type animal;
+    Node * prev{};
+    Node * next{};
+    Node * next_same{};
+  };
+
+  struct SpeciesQueue
+  {
+    Node * head{};
+    Node * tail{};
+  };
+
+  template <typename Animal>
+  void push(Animal && animal)
+  {
+    Node * const n = alloc();
+    n->animal = std::forward<Animal>(animal);
+    n->prev = m_tail;
+    n->next = nullptr;
+    n->next_same = nullptr;
+    if (m_tail) m_tail->next = n;
+    else m_head = n;
+    m_tail = n;
+
+    SpeciesQueue & q = m_species[n->animal.index()];
+    if (q.tail) q.tail->next_same = n;
+    else q.head = n;
+    q.tail = n;
+  }
+
+  /**
+   * @brief Unlink a node that is at the head of its species queue and move its animal out.
+   */
+  element_type take(Node * const n)
+  {
+    SpeciesQueue & q = m_species[n->animal.index()];
+    assert(q.head == n);
+    q.head = n->next_same;
+    if (!q.head) q.tail = nullptr;
+
+    if (n->prev) n->prev->next = n->next;
+    else m_head = n->next;
+    if (n->next) n->next->prev = n->prev;
+    else m_tail = n->prev;
+
+    element_type animal = std::move(n->animal);
+    n->next = m_free;
+    m_free = n;
+    return animal;
+  }
+
+  Node * alloc()
+  {
+    if (!m_free)
+    {
+      size_t const size = m_chunks.empty() ? 64 : 2 * m_chunk_size;
+      m_chunks.emplace_back(new Node[size]);
+      m_chunk_size = size;
+      for (size_t i = 0; i < size; ++i)
+      {
+        m_chunks.back()[i].next = m_free;
+        m_free = &m_chunks.back()[i];
+      }
+    }
+    Node * const n = m_free;
+    m_free = n->next;
+    return n;
+  }
+
+  Node * m_head{};
+  Node * m_tail{};
+  std::array<SpeciesQueue, std::variant_size_v<element_type>> m_species{};
+  Node * m_free{};
+  std::vector<std::unique_ptr<Node[]>> m_chunks;
+  size_t m_chunk_size{};
+};
+
+/**
+ * @brief Generic shelter over any set of animal types.
+ *
+ * Instead of a global arrival list, each type has its own FIFO ring buffer of (arrival stamp, animal)
+ * pairs, stamps coming from one increasing counter. The oldest animal overall is the ring head with
+ * the smallest stamp, found by a comparison per type that is unrolled at compile time.
+ * Type-specific dequeues touch only their own ring, and dequeue_n moves out a batch of one type.
+ * Time complexity: O(1) amortized enqueue and typed dequeue, O(K) dequeueAny for K types.
+ * Space complexity: O(N).
+ */
+template <typename... Types>
+class ShelterQueue
+{
+public:
+
+  using value_type = std::variant<Types...>;
+
+  ShelterQueue() = default;
+
+  template <typename A>
+  void enqueue(A && animal)
+  {
+    using T = std::decay_t<A>;
+    queue<T>().push({ m_next_stamp++, std::forward<A>(animal) });
+  }
+
+  value_type dequeueAny()
+  {
+    assert(!empty());
+    return take_oldest(std::index_sequence_for<Types...>{});
+  }
+
+  template <typename A>
+  A dequeue()
+  {
+    auto & q = queue<A>();
+    assert(!q.empty());
+    A animal = std::move(q.front().animal);
+    q.pop();
+    return animal;
+  }
+
+  /**
+   * @brief Move up to @p n of the longest-waiting animals of type A to @p out.
+   * @return the output iterator past the last animal written
+   */
+  template <typename A, typename OutIt>
+  OutIt dequeue_n(size_t n, OutIt out)
+  {
+    auto & q = queue<A>();
+    for (n = std::min(n, q.size()); n > 0; --n, ++out)
+    {
+      *out = std::move(q.front().animal);
+      q.pop();
+    }
+    return out;
+  }
+
+  template <typename A>
+  [[nodiscard]]
+  size_t count() const
+  {
+    return std::get<RingQueue<Stamped<A>>>(m_queues).size();
+  }
+
+  [[nodiscard]]
+  size_t size() const
+  {
+    return std::apply([](auto const &... q) { return (q.size() + ... + size_t{0}); }, m_queues);
+  }
+
+  [[nodiscard]]
+  bool empty() const
+  {
+    return size() == 0;
+  }
+
+private:
+
+  template <typename A>
+  struct Stamped
+  {
+    std::uint64_t stamp;
+    A animal;
+  };
+
+  template <typename A>
+  RingQueue<Stamped<A>> & queue()
+  {
+    static_assert((std::is_same_v<A, Types> || ...), "not one of the shelter's animal types");
+    return std::get<RingQueue<Stamped<A>>>(m_queues);
+  }
+
+  template <size_t... I>
+  value_type take_oldest(std::index_sequence<I...>)
+  {
+    size_t oldest = 0;
+    std::uint64_t oldest_stamp = std::numeric_limits<std::uint64_t>::max();
+    auto const consider = [&](size_t const i, auto const & q)
+    {
+      if (!q.empty() && q.front().stamp < oldest_stamp)
+      {
+        oldest = i;
+        oldest_stamp = q.front().stamp;
+      }
+    };
+    (consider(I, std::get<I>(m_queues)), ...);
+
+    std::optional<value_type> animal;
+    auto const take = [&](auto const index, auto & q)
+    {
+      if (oldest != index) return;
+      animal.emplace(std::in_place_index<decltype(index)::value>, std::move(q.front().animal));
+      q.pop();
+    };
+    (take(std::integral_constant<size_t, I>{}, std::get<I>(m_queues)), ...);
+    return std::move(*animal);
+  }
+
+  std::tuple<RingQueue<Stamped<Types>>...> m_queues;
+  std::uint64_t m_next_stamp{};
+};
+
+template <size_t I>
+struct Species
+{
+  std::uint32_t id;
+};
+
+/**
+ * @brief Shelter that many intake and adopter threads can use at once, without a global lock.
+ *
+ * Like ShelterQueue, each type has its own FIFO of (arrival stamp, animal) pairs, but here it is
+ * a bounded lock-free MpmcQueue and stamps come from an atomic counter. Typed dequeues only touch
+ * their own queue. dequeueAny peeks at the stamp at the head of every queue, then pops from the queue
+ * with the oldest one; if another adopter emptied that queue meanwhile, it looks again.
+ * Order within a type is exact FIFO. Order across types is exact while no other thread is modifying
+ * the shelter, and best-effort otherwise: a concurrent dequeue may take the peeked animal, leaving
+ * the next one of that type, and an intake blocked on a full queue keeps its earlier stamp.
+ * Time complexity: O(1) enqueue and typed dequeue, O(K) dequeueAny for K types (without contention).
+ * Space complexity: O(K * capacity).
+ */
+template <typename... Types>
+class ConcurrentShelterQueue
+{
+public:
+
+  using value_type = std::variant<Types...>;
+
+  /**
+   * @param capacity maximum number of animals of each type (rounded up to a power of two)
+   */
+  explicit ConcurrentShelterQueue(size_t capacity = 1024)
+  : m_queues((static_cast<void>(sizeof(Types)), capacity)...)
+  {}
+
+  /**
+   * @brief Enqueue, waiting for an adopter to make room if the queue for this type is full.
+   */
+  template <typename A>
+  void enqueue(A && animal)
+  {
+    using T = std::decay_t<A>;
+    Stamped<T> item(m_next_stamp.fetch_add(1, std::memory_order_relaxed), std::forward<A>(animal));
+    while (!queue<T>().try_push(std::move(item))) std::this_thread::yield();
+  }
+
+  /**
+   * @return the longest-waiting animal of any type, or nothing if the shelter is empty
+   */
+  std::optional<value_type> try_dequeueAny()
+  {
+    for (;;)
+    {
+      auto const oldest = find_oldest(std::index_sequence_for<Types...>{});
+      if (!oldest) return std::nullopt;
+      if (auto animal = try_take(*oldest, std::index_sequence_for<Types...>{})) return animal;
+    }
+  }
+
+  /**
+   * @return the longest-waiting animal of type A, or nothing if there is none
+   */
+  template <typename A>
+  std::optional<A> try_dequeue()
+  {
+    Stamped<A> item;
+    if (!queue<A>().try_pop(item)) return std::nullopt;
+    return std::move(item.animal);
+  }
+
+  /**
+   * @brief Number of animals of type A; approximate while other threads are active.
+   */
+  template <typename A>
+  [[nodiscard]]
+  size_t count() const
+  {
+    return std::get<MpmcQueue<Stamped<A>>>(m_queues).size();
+  }
+
+  /**
+   * @brief Number of animals; approximate while other threads are active.
+   */
+  [[nodiscard]]
+  size_t size() const
+  {
+    return std::apply([](auto const &... q) { return (q.size() + ... + size_t{0}); }, m_queues);
+  }
+
+  [[nodiscard]]
+  bool empty() const
+  {
+    return size() == 0;
+  }
+
+private:
+
+  // the stamp is atomic so that dequeueAny can peek at it while the animal is being moved out
+  template <typename A>
+  struct Stamped
+  {
+    Stamped() = default;
+
+    Stamped(std::uint64_t s, A a) : stamp(s), animal(std::move(a)) {}
+
+    Stamped & operator=(Stamped && other)
+    {
+      stamp.store(other.stamp.load(std::memory_order_relaxed), std::memory_order_relaxed);
+      animal = std::move(other.animal);
+      return *this;
+    }
+
+    std::atomic<std::uint64_t> stamp{};
+    A animal{};
+  };
+
+  template <typename A>
+  MpmcQueue<Stamped<A>> & queue()
+  {
+    static_assert((std::is_same_v<A, Types> || ...), "not one of the shelter's animal types");
+    return std::get<MpmcQueue<Stamped<A>>>(m_queues);
+  }
+
+  /**
+   * @return index of the type whose head has the smallest stamp, or nothing if all queues look empty
+   */
+  template <size_t... I>
+  std::optional<size_t> find_oldest(std::index_sequence<I...>) const
+  {
+    std::optional<size_t> oldest;
+    std::uint64_t oldest_stamp = std::numeric_limits<std::uint64_t>::max();
+    auto const consider = [&](size_t const i, auto const & q)
+    {
+      auto const stamp = q.try_peek([](auto const & item) { return item.stamp.load(std::memory_order_acquire); });
+      if (stamp && *stamp < oldest_stamp)
+      {
+        oldest = i;
+        oldest_stamp = *stamp;
+      }
+    };
+    (consider(I, std::get<I>(m_queues)), ...);
+    return oldest;
+  }
+
+  template <size_t... I>
+  std::optional<value_type> try_take(size_t const index, std::index_sequence<I...>)
+  {
+    std::optional<value_type> animal;
+    auto const take = [&](auto const i)
+    {
+      using A = std::variant_alternative_t<decltype(i)::value, value_type>;
+      if (index != i) return;
+      if (auto a = try_dequeue<A>()) animal.emplace(std::in_place_index<decltype(i)::value>, std::move(*a));
+    };
+    (take(std::integral_constant<size_t, I>{}), ...);
+    return animal;
+  }
+
+  std::tuple<MpmcQueue<Stamped<Types>>...> m_queues;
+  alignas(concurrent::cache_line_size) std::atomic<std::uint64_t> m_next_stamp{0};
+};
+
+using ConcurrentAnimalShelter = ConcurrentShelterQueue<Cat, Dog>;
+
+template <typename Shelter>
+void test()
+{
+  Shelter s;
   s.enqueue(Cat{"Barsik"});
   s.enqueue(Cat{"Pushok"});
   s.enqueue(Dog{"Sharik"});
@@ -121,4 +628,352 @@ int main()
   auto a9 = s.dequeueAny();
   assert(std::holds_alternative<Cat>(a9));
   assert(std::get<Cat>(a9).name == "Hosiko");
+
+  // queues are empty again, refill to reuse released storage
+  s.enqueue(Dog{"Tuzik"});
+  s.enqueue(Cat{"Murka"});
+  s.enqueue(Dog{"Druzhok"});
+  Cat a10 = s.dequeueCat();
+  assert(a10.name == "Murka");
+  auto a11 = s.dequeueAny();
+  assert(std::get<Dog>(a11).name == "Tuzik");
+  Dog a12 = s.dequeueDog();
+  assert(a12.name == "Druzhok");
+}
+
+/**
+ * After a warm-up round grows the pool, cycling animals (with names too long for the small string buffer)
+ * through the shelter must not allocate. Animals are moved out of and back into vectors of fixed capacity.
+ */
+void test_no_allocations()
+{
+  size_t const n = 100;
+  IntrusiveAnimalShelter s;
+  std::vector<Cat> cats;
+  std::vector<Dog> dogs;
+  cats.reserve(n);
+  dogs.reserve(n);
+  for (size_t i = 0; i < n; ++i)
+  {
+    cats.push_back(Cat{"a cat with a rather long name #" + std::to_string(i)});
+    dogs.push_back(Dog{"a dog with a rather long name #" + std::to_string(i)});
+  }
+
+  auto const cycle = [&]
+  {
+    for (size_t i = 0; i < n; ++i)
+    {
+      s.enqueue(std::move(cats.back()));
+      cats.pop_back();
+      s.enqueue(std::move(dogs.back()));
+      dogs.pop_back();
+    }
+    for (size_t i = 0; i < n / 2; ++i)
+    {
+      cats.push_back(s.dequeueCat());
+      dogs.push_back(s.dequeueDog());
+    }
+    while (!s.empty())
+    {
+      auto a = s.dequeueAny();
+      if (auto * c = std::get_if<Cat>(&a)) cats.push_back(std::move(*c));
+      else dogs.push_back(std::get<Dog>(std::move(a)));
+    }
+  };
+
+  cycle();
+  [[maybe_unused]] size_t const before = allocation::num_allocations.load();
+  for (int r = 0; r < 10; ++r) cycle();
+  assert(allocation::num_allocations.load() == before);
+  assert(cats.size() == n && dogs.size() == n);
+  assert(cats.front().name.size() > 30 && dogs.back().name.size() > 30);
+}
+
+void test_shelter_queue()
+{
+  ShelterQueue<Cat, Dog> s;
+  assert(s.empty());
+  s.enqueue(Cat{"Barsik"});
+  s.enqueue(Dog{"Sharik"});
+  s.enqueue(Cat{"Pushok"});
+  s.enqueue(Dog{"Strelka"});
+  s.enqueue(Dog{"Belka"});
+  s.enqueue(Cat{"Maple"});
+  assert(s.size() == 6 && s.count<Cat>() == 3);
+
+  auto a1 = s.dequeueAny();
+  assert(std::get<Cat>(a1).name == "Barsik");
+  Cat c1 = s.dequeue<Cat>();
+  assert(c1.name == "Pushok");
+  std::vector<Dog> dogs;
+  s.dequeue_n<Dog>(2, std::back_inserter(dogs));
+  assert(dogs.size() == 2 && dogs[0].name == "Sharik" && dogs[1].name == "Strelka");
+  auto a2 = s.dequeueAny();
+  assert(std::get<Dog>(a2).name == "Belka");
+  s.dequeue_n<Dog>(5, std::back_inserter(dogs));
+  assert(dogs.size() == 2);
+  auto a3 = s.dequeueAny();
+  assert(std::get<Cat>(a3).name == "Maple");
+  assert(s.empty());
+
+  // more types, checked against a single arrival-ordered reference queue
+  ShelterQueue<int, char, double, std::string> m;
+  std::vector<std::variant<int, char, double, std::string>> ref;
+  std::mt19937 gen(3);
+  size_t next = 0;
+  for (int i = 0; i < 10000; ++i)
+  {
+    switch (gen() % 5)
+    {
+      case 0: m.enqueue(i); ref.emplace_back(i); break;
+      case 1: m.enqueue(static_cast<char>(i % 128)); ref.emplace_back(static_cast<char>(i % 128)); break;
+      case 2: m.enqueue(i * 0.5); ref.emplace_back(i * 0.5); break;
+      case 3: m.enqueue(std::to_string(i)); ref.emplace_back(std::to_string(i)); break;
+      default:
+        if (next < ref.size())
+        {
+          [[maybe_unused]] auto const a = m.dequeueAny();
+          assert(a == ref[next]);
+          ++next;
+        }
+    }
+  }
+  for (; next < ref.size(); ++next)
+  {
+    [[maybe_unused]] auto const a = m.dequeueAny();
+    assert(a == ref[next]);
+  }
+  assert(m.empty());
+}
+
+/**
+ * Single-threaded, the concurrent shelter behaves exactly like the sequential ones. With several intake
+ * and adopter threads, every animal is adopted exactly once, and each adopter sees the animals of one type
+ * from one intake thread in the order they arrived.
+ */
+void test_concurrent_shelter(unsigned const num_producers, unsigned const num_consumers, size_t const capacity)
+{
+  {
+    ConcurrentAnimalShelter s(4);
+    s.enqueue(Cat{"Barsik"});
+    s.enqueue(Dog{"Sharik"});
+    s.enqueue(Dog{"Strelka"});
+    s.enqueue(Cat{"Pushok"});
+    assert(s.size() == 4 && s.count<Dog>() == 2);
+    auto a1 = s.try_dequeueAny();
+    assert(a1 && std::get<Cat>(*a1).name == "Barsik");
+    auto c1 = s.try_dequeue<Cat>();
+    assert(c1 && c1->name == "Pushok");
+    auto c2 = s.try_dequeue<Cat>();
+    assert(!c2);
+    auto a2 = s.try_dequeueAny();
+    assert(a2 && std::get<Dog>(*a2).name == "Sharik");
+    auto a3 = s.try_dequeueAny();
+    assert(a3 && std::get<Dog>(*a3).name == "Strelka");
+    auto a4 = s.try_dequeueAny();
+    assert(!a4 && s.empty());
+  }
+
+  using Shelter = ConcurrentShelterQueue<Species<0>, Species<1>, Species<2>>;
+  std::uint32_t const per_producer = 20000;
+  std::uint64_t const total = std::uint64_t{num_producers} * per_producer;
+  Shelter s(capacity);
+  std::atomic<std::uint64_t> adopted{0};
+  std::vector<std::vector<std::uint32_t>> seen(num_consumers); // ids as (producer << 20 | seq << 2 | type)
+
+  std::vector<std::thread> threads;
+  for (unsigned p = 0; p < num_producers; ++p)
+  {
+    threads.emplace_back([&, p]
+    {
+      std::mt19937 gen(p);
+      for (std::uint32_t seq = 0; seq < per_producer; ++seq)
+      {
+        std::uint32_t const id = p << 20 | seq << 2;
+        switch (gen() % 3)
+        {
+          case 0: s.enqueue(Species<0>{id}); break;
+          case 1: s.enqueue(Species<1>{id | 1}); break;
+          default: s.enqueue(Species<2>{id | 2}); break;
+        }
+      }
+    });
+  }
+  for (unsigned c = 0; c < num_consumers; ++c)
+  {
+    threads.emplace_back([&, c]
+    {
+      std::vector<std::int64_t> last(std::size_t{num_producers} * 3, -1);
+      auto const check = [&](std::uint32_t const id)
+      {
+        auto & prev = last[(id >> 20) * 3 + (id & 3)];
+        assert(static_cast<std::int64_t>(id >> 2 & 0x3ffff) > prev);
+        prev = id >> 2 & 0x3ffff;
+        seen[c].push_back(id);
+        adopted.fetch_add(1, std::memory_order_relaxed);
+      };
+      for (size_t i = 0; adopted.load(std::memory_order_relaxed) < total; ++i)
+      {
+        bool got = false;
+        if (i % 3 == 0)
+        {
+          if (auto a = s.try_dequeue<Species<1>>())
+          {
+            check(a->id);
+            got = true;
+          }
+        }
+        else if (auto a = s.try_dequeueAny())
+        {
+          std::visit([&](auto const & animal) { check(animal.id); }, *a);
+          got = true;
+        }
+        if (!got) std::this_thread::yield();
+      }
+    });
+  }
+  for (auto & t : threads) t.join();
+
+  std::vector<std::uint32_t> all;
+  for (auto const & v : seen) all.insert(all.end(), v.begin(), v.end());
+  std::sort(all.begin(), all.end());
+  assert(all.size() == total);
+  assert(std::adjacent_find(all.begin(), all.end()) == all.end());
+  assert(s.empty());
+}
+
+/**
+ * 10^7 operations: every step enqueues an animal of a random type and every other step
+ * dequeues the oldest one; every 64 steps a batch of up to 16 animals of the first type is adopted.
+ */
+template <typename... Types>
+void bench_shelter(std::string const & name)
+{
+  using First = std::tuple_element_t<0, std::tuple<Types...>>;
+  size_t const ops = 10000000;
+  constexpr size_t k = sizeof...(Types);
+  std::mt19937 gen(42);
+  std::vector<std::uint8_t> types(ops);
+  for (auto & t : types) t = static_cast<std::uint8_t>(gen() % k);
+
+  benchmark::report(name, ops, benchmark::measure([&]
+  {
+    ShelterQueue<Types...> s;
+    std::vector<First> batch;
+    batch.reserve(16);
+    std::uint64_t sum = 0;
+    for (size_t i = 0; i < ops; ++i)
+    {
+      std::uint32_t const id = static_cast<std::uint32_t>(i);
+      size_t t = 0;
+      ((types[i] == t++ ? s.enqueue(Types{id}) : void()), ...);
+      if (i % 2 == 1 && !s.empty()) sum += s.dequeueAny().index();
+      if (i % 64 == 0)
+      {
+        batch.clear();
+        s.template dequeue_n<First>(16, std::back_inserter(batch));
+        sum += batch.size();
+      }
+    }
+    benchmark::do_not_optimize(sum);
+  }));
+}
+
+template <size_t... I>
+void bench_species(std::index_sequence<I...>)
+{
+  bench_shelter<Species<I>...>("ShelterQueue " + std::to_string(sizeof...(I)) + " types");
+}
+
+/**
+ * 2 * 10^6 operations split between @p num_threads threads, each of which alternates between taking in
+ * an animal of a random type and adopting the oldest one. The baseline guards a ShelterQueue with a mutex.
+ */
+template <typename Shelter, typename Enqueue, typename Dequeue>
+void bench_threads(std::string const & name, unsigned const num_threads, Enqueue enqueue, Dequeue dequeue)
+{
+  size_t const ops = 2000000;
+  size_t const per_thread = ops / 2 / num_threads;
+  benchmark::report(name + " " + std::to_string(num_threads) + " threads", ops, benchmark::measure([&]
+  {
+    Shelter s;
+    std::vector<std::thread> threads;
+    for (unsigned t = 0; t < num_threads; ++t)
+    {
+      threads.emplace_back([&, t]
+      {
+        std::minstd_rand gen(t + 1);
+        std::uint64_t sum = 0;
+        for (size_t i = 0; i < per_thread; ++i)
+        {
+          enqueue(s, static_cast<std::uint32_t>(gen()));
+          sum += dequeue(s);
+        }
+        benchmark::do_not_optimize(sum);
+      });
+    }
+    for (auto & t : threads) t.join();
+  }, 1));
+}
+
+struct LockedShelter
+{
+  std::mutex mutex;
+  ShelterQueue<Species<0>, Species<1>> shelter;
+};
+
+void bench_concurrent()
+{
+  using Concurrent = ConcurrentShelterQueue<Species<0>, Species<1>>;
+  auto const id = [](auto const & animal) { return size_t{animal.id}; };
+  for (unsigned const n : {1u, 2u, 4u, 8u, 16u, 32u})
+  {
+    bench_threads<LockedShelter>("ShelterQueue + mutex", n,
+      [](LockedShelter & s, std::uint32_t const r)
+      {
+        std::lock_guard<std::mutex> lock(s.mutex);
+        if (r % 2) s.shelter.enqueue(Species<0>{r});
+        else s.shelter.enqueue(Species<1>{r});
+      },
+      [&](LockedShelter & s) -> size_t
+      {
+        std::lock_guard<std::mutex> lock(s.mutex);
+        return s.shelter.empty() ? 0 : std::visit(id, s.shelter.dequeueAny());
+      });
+    bench_threads<Concurrent>("ConcurrentShelterQueue", n,
+      [](Concurrent & s, std::uint32_t const r)
+      {
+        if (r % 2) s.enqueue(Species<0>{r});
+        else s.enqueue(Species<1>{r});
+      },
+      [&](Concurrent & s) -> size_t
+      {
+        auto a = s.try_dequeueAny();
+        return a ? std::visit(id, *a) : 0;
+      });
+  }
+}
+
+void bench()
+{
+  bench_species(std::make_index_sequence<2>{});
+  bench_species(std::make_index_sequence<8>{});
+}
+
+int main(int argc, char ** argv)
+{
+  test<AnimalShelter>();
+  test<PoolAnimalShelter>();
+  test<IntrusiveAnimalShelter>();
+  test_no_allocations();
+  test_shelter_queue();
+  test_concurrent_shelter(1, 1, 2);
+  test_concurrent_shelter(4, 4, 16);
+  test_concurrent_shelter(2, 5, 1024);
+
+  if (benchmark::requested(argc, argv))
+  {
+    bench();
+    bench_concurrent();
+  }
 }
@@ -1,10 +1,22 @@
 #include "Tree.hpp"
 #include "testing.hpp"
 #include "printing.hpp"
+#include "benchmark.hpp"
+#include "parallel.hpp"
 
 #include <vector>
+#include <array>
+#include <string>
+#include <sstream>
+#include <iterator>
+#include <random>
+#include <algorithm>
+#include <thread>
+#include <memory>
+#include <new>
 #include <cassert>
 #include <cmath>
+#include <cstdlib>
 #include <numeric>
 
 namespace impl
@@ -21,6 +33,43 @@ typename BinaryTree<T>::Node * make_min_tree(Iter first, Iter last)
   node->right = make_min_tree<T>(mid + 1, last);
   return node;
 }
+
+/**
+ * @brief Construct the nodes of the minimal tree over [lo, hi) in place, node i in nodes[i].
+ *
+ * Splits at the same midpoints as make_min_tree above, so the shape is identical.
+ * Ranges longer than @p cutoff hand their left half to a new thread while @p num_threads allows.
+ */
+template<typename Node, typename Iter>
+Node * link_min_tree(Node * const nodes, Iter const first, size_t const lo, size_t const hi,
+                     unsigned const num_threads, size_t const cutoff)
+{
+  if (lo == hi) return nullptr;
+  size_t const mid = lo + (hi - lo) / 2;
+  Node * left;
+  Node * right;
+  if (num_threads > 1 && hi - lo > cutoff)
+  {
+    std::thread t([&]{ left = link_min_tree(nodes, first, lo, mid, num_threads / 2, cutoff); });
+    right = link_min_tree(nodes, first, mid + 1, hi, num_threads - num_threads / 2, cutoff);
+    t.join();
+  }
+  else
+  {
+    left = link_min_tree(nodes, first, lo, mid, 1, cutoff);
+    right = link_min_tree(nodes, first, mid + 1, hi, 1, cutoff);
+  }
+  return new (nodes + mid) Node{ first[mid], left, right };
+}
+
+template<typename T>
+void fill_eytzinger(T const * & in, std::vector<T> & out, size_t const k)
+{
+  if (k >= out.size()) return;
+  fill_eytzinger(in, out, 2 * k + 1);
+  out[k] = *in++;
+  fill_eytzinger(in, out, 2 * k + 2);
+}
 }
 
 /**
@@ -37,22 +86,448 @@ BinaryTree<T> make_min_tree(std::vector<T> const & input)
   return res;
 }
 
+/**
+ * @brief Minimal tree whose nodes all live in one contiguous block.
+ *
+ * The node holding the i-th smallest value sits at index i of the block, so the block
+ * is sorted and the tree can be released with a single deallocation.
+ */
+template<typename T>
+class BlockTree
+{
+public:
+
+  using Node = typename BinaryTree<T>::Node;
+
+  BlockTree() = default;
+
+  explicit BlockTree(size_t const n)
+  : m_nodes(n > 0 ? static_cast<Node *>(::operator new(n * sizeof(Node))) : nullptr), m_size(n)
+  {}
+
+  BlockTree(BlockTree && other) noexcept
+  : root(std::exchange(other.root, nullptr)),
+    m_nodes(std::exchange(other.m_nodes, nullptr)),
+    m_size(std::exchange(other.m_size, 0))
+  {}
+
+  BlockTree & operator=(BlockTree other) noexcept
+  {
+    std::swap(root, other.root);
+    std::swap(m_nodes, other.m_nodes);
+    std::swap(m_size, other.m_size);
+    return *this;
+  }
+
+  ~BlockTree()
+  {
+    if (!m_nodes) return;
+    if (root) std::destroy_n(m_nodes, m_size);
+    ::operator delete(m_nodes);
+  }
+
+  /**
+   * @brief Start of the block; nodes are constructed in it by the builder.
+   */
+  [[nodiscard]] Node * data() const
+  {
+    return m_nodes;
+  }
+
+  [[nodiscard]] size_t size() const
+  {
+    return m_size;
+  }
+
+  [[nodiscard]] size_t depth() const
+  {
+    return tree_ops::depth(root);
+  }
+
+  [[nodiscard]] std::vector<T> values() const
+  {
+    std::vector<T> vals;
+    tree_ops::values(root, vals);
+    return vals;
+  }
+
+  [[nodiscard]] Node const * find_bst(T const & v) const
+  {
+    return tree_ops::find_bst(root, v);
+  }
+
+  Node * root{};
+
+private:
+
+  Node * m_nodes{};
+  size_t m_size{};
+};
+
+/**
+ * @brief Minimal Tree, allocated as one block and built in parallel.
+ *
+ * Same tree as make_min_tree, but all nodes come from a single allocation, node i at in-order index i,
+ * so no per-node allocator calls are made. Subtrees larger than @p cutoff are linked on separate threads,
+ * up to @p num_threads in total; each thread constructs (and first touches) the nodes of its own range.
+ * Time complexity: O(N) work, O(N/P + log N) span.
+ * Space complexity: O(N) for the nodes, O(log N) stack per thread.
+ */
+template<typename T>
+BlockTree<T> make_min_tree_block(std::vector<T> const & input,
+                                 unsigned const num_threads = parallel::default_threads(),
+                                 size_t const cutoff = size_t{1} << 16)
+{
+  BlockTree<T> res(input.size());
+  res.root = impl::link_min_tree(res.data(), input.begin(), 0, input.size(), num_threads, cutoff);
+  return res;
+}
+
+/**
+ * @brief Minimal-height search tree in Eytzinger (breadth-first) layout.
+ *
+ * The tree is implicit: the children of element k are elements 2k+1 and 2k+2, so no links are stored.
+ * This is the complete-tree shape rather than the midpoint-split shape of make_min_tree, but it has the same,
+ * minimal, height. It is filled by an in-order walk of the implicit tree that reads the input sequentially.
+ * Time complexity: O(N).
+ * Space complexity: O(N) for the output, O(log N) stack.
+ */
+template<typename T>
+std::vector<T> make_min_tree_eytzinger(std::vector<T> const & input)
+{
+  std::vector<T> res(input.size());
+  T const * in = input.data();
+  impl::fill_eytzinger(in, res, 0);
+  return res;
+}
+
+/**
+ * @brief Look up @p v in a tree built by make_min_tree_eytzinger.
+ * @return index of v in @p tree, or tree.size() if absent
+ */
+template<typename T>
+size_t find_eytzinger(std::vector<T> const & tree, T const & v)
+{
+  size_t k = 0;
+  while (k < tree.size() && tree[k] != v)
+  {
+    k = 2 * k + 1 + (tree[k] < v);
+  }
+  return std::min(k, tree.size());
+}
+
+/**
+ * @brief One-pass builder of a minimal tree from a sorted stream of unknown length.
+ *
+ * Value i (counting from 1) is placed as if in a perfect tree, at height ctz(i) above the leaves.
+ * Only the latest node of every height is remembered: a new node takes the latest node one level down
+ * as its left child, and becomes the right child of the latest node one level up when it is
+ * that node's right child in the perfect tree (bit l+1 of i set). When the stream ends, the nodes
+ * still waiting for a parent are hooked up along the right spine: going down from the root,
+ * each remembered node that comes after the current spine node in order becomes its right child.
+ * The result has minimal height, although its shape is not the midpoint split of make_min_tree.
+ * Time complexity: O(N) total, O(1) amortized per value.
+ * Space complexity: O(log N) besides the tree itself.
+ */
+template<typename T>
+class MinTreeBuilder
+{
+public:
+
+  using Node = typename BinaryTree<T>::Node;
+
+  MinTreeBuilder() = default;
+
+  MinTreeBuilder(MinTreeBuilder const &) = delete;
+  MinTreeBuilder & operator=(MinTreeBuilder const &) = delete;
+
+  ~MinTreeBuilder()
+  {
+    tree_ops::erase(finish_root());
+  }
+
+  /**
+   * @brief Append the next value; must not be smaller than the previous one.
+   */
+  void push(T value)
+  {
+    size_t const i = ++m_count;
+    size_t level = 0;
+    while (((i >> level) & 1) == 0) ++level;
+    Node * const node = new Node{ std::move(value), level > 0 ? m_last[level - 1] : nullptr, nullptr };
+    if (((i >> level) & 3) == 3) m_last[level + 1]->right = node;
+    m_last[level] = node;
+  }
+
+  /**
+   * @brief Link up the right spine and hand over the tree; the builder starts over empty.
+   */
+  BinaryTree<T> finish()
+  {
+    return BinaryTree<T>(finish_root());
+  }
+
+private:
+
+  Node * finish_root()
+  {
+    if (m_count == 0) return nullptr;
+    size_t top = 0;
+    while ((m_count >> (top + 1)) > 0) ++top;
+    Node * const root = m_last[top];
+    Node * spine = root;
+    size_t spine_pos = position(top);
+    for (size_t l = top; l-- > 0;)
+    {
+      size_t const pos = position(l);
+      if (pos > spine_pos)
+      {
+        spine->right = m_last[l];
+        spine = m_last[l];
+        spine_pos = pos;
+      }
+    }
+    m_last.fill(nullptr);
+    m_count = 0;
+    return root;
+  }
+
+  /**
+   * @brief In-order position (from 1) of the latest node at @p level.
+   */
+  size_t position(size_t const level) const
+  {
+    size_t const step = size_t{1} << (level + 1);
+    return (m_count + step / 2) / step * step - step / 2;
+  }
+
+  std::array<Node *, 64> m_last{};
+  size_t m_count{};
+};
+
+/**
+ * @brief Minimal Tree from a sorted input range of any kind, read in one pass (e.g. from a stream).
+ */
+template<typename InputIt>
+auto make_min_tree(InputIt first, InputIt last)
+{
+  MinTreeBuilder<typename std::iterator_traits<InputIt>::value_type> builder;
+  for (; first != last; ++first) builder.push(*first);
+  return builder.finish();
+}
+
+namespace impl
+{
+/**
+ * @brief Input iterator over the values of a binary tree in order, keeping only the path to the current node.
+ */
+template<typename Node>
+class InorderIterator
+{
+public:
+
+  using iterator_category = std::input_iterator_tag;
+  using value_type = typename Node::value_type;
+  using difference_type = std::ptrdiff_t;
+  using pointer = value_type const *;
+  using reference = value_type const &;
+
+  InorderIterator() = default;
+
+  explicit InorderIterator(Node const * root)
+  {
+    descend(root);
+  }
+
+  reference operator*() const
+  {
+    return m_path.back()->value;
+  }
+
+  InorderIterator & operator++()
+  {
+    Node const * const node = m_path.back();
+    m_path.pop_back();
+    descend(node->right);
+    return *this;
+  }
+
+  bool operator==(InorderIterator const & other) const
+  {
+    return m_path == other.m_path;
+  }
+
+  bool operator!=(InorderIterator const & other) const
+  {
+    return !(*this == other);
+  }
+
+private:
+
+  void descend(Node const * node)
+  {
+    for (; node; node = node->left) m_path.push_back(node);
+  }
+
+  std::vector<Node const *> m_path;
+};
+}
+
+/**
+ * @brief Merge two binary search trees into a new minimal-height one.
+ *
+ * Both trees are walked in order at the same time and the merged sequence is fed straight into
+ * a MinTreeBuilder, so no intermediate array is materialized. Values present in both trees are kept twice.
+ * Time complexity: O(N + M).
+ * Space complexity: O(height(a) + height(b) + log(N + M)) besides the new tree.
+ */
+template<typename T>
+BinaryTree<T> merge_bsts(BinaryTree<T> const & a, BinaryTree<T> const & b)
+{
+  using It = impl::InorderIterator<typename BinaryTree<T>::Node>;
+  MinTreeBuilder<T> builder;
+  It ia(a.root), ib(b.root);
+  It const end;
+  while (ia != end && ib != end)
+  {
+    It & next = *ib < *ia ? ib : ia;
+    builder.push(*next);
+    ++next;
+  }
+  for (; ia != end; ++ia) builder.push(*ia);
+  for (; ib != end; ++ib) builder.push(*ib);
+  return builder.finish();
+}
+
+std::vector<int> make_input(size_t const len)
+{
+  std::vector<int> res(len);
+  std::iota(res.begin(), res.end(), 1);
+  return res;
+}
+
 void test(std::vector<int> const & input)
 {
   auto res = make_min_tree(input);
   EXPECT_EQ(res.size(), input.size());
   EXPECT_EQ(res.depth(), (input.empty() ? 0 : size_t(std::log2(input.size()))+1));
   EXPECT_EQ(res.values(), input);
+
+  size_t const depth = res.depth();
+  for (unsigned const threads : {1u, 2u, 3u})
+  {
+    auto block = make_min_tree_block(input, threads, 2);
+    EXPECT_EQ(block.size(), input.size());
+    EXPECT_EQ(block.depth(), depth);
+    EXPECT_EQ(block.values(), input);
+    EXPECT(tree_ops::compare(block.root, res.root, std::equal_to<>{}));
+    for (size_t i = 0; i < input.size(); ++i) EXPECT(block.find_bst(input[i]) == block.data() + i);
+  }
+
+  auto const flat = make_min_tree_eytzinger(input);
+  EXPECT_EQ(flat.size(), input.size());
+  size_t flat_depth = 0;
+  for (size_t k = 0; k < flat.size(); k = 2 * k + 1) ++flat_depth;
+  EXPECT_EQ(flat_depth, depth);
+  for (int const v : input) EXPECT(flat[find_eytzinger(flat, v)] == v);
+  EXPECT_EQ(find_eytzinger(flat, 0), flat.size());
+
+  std::stringstream ss;
+  for (int const v : input) ss << v << ' ';
+  auto streamed = make_min_tree(std::istream_iterator<int>(ss), std::istream_iterator<int>());
+  EXPECT_EQ(streamed.size(), input.size());
+  EXPECT_EQ(streamed.depth(), depth);
+  EXPECT_EQ(streamed.values(), input);
 }
 
-std::vector<int> make_input(size_t const len)
+/**
+ * Every length up to a few perfect trees past 2^8, so each spine configuration occurs.
+ */
+void test_streaming()
 {
-  std::vector<int> res(len);
-  std::iota(res.begin(), res.end(), 1);
-  return res;
+  for (size_t n = 0; n <= 600; ++n)
+  {
+    auto const input = make_input(n);
+    auto res = make_min_tree(input.begin(), input.end());
+    EXPECT_EQ(res.depth(), (n == 0 ? 0 : size_t(std::log2(n)) + 1));
+    EXPECT_EQ(res.values(), input);
+  }
+
+  // the builder can be reused after finish()
+  MinTreeBuilder<int> builder;
+  for (int i = 0; i < 10; ++i) builder.push(i);
+  EXPECT_EQ(builder.finish().size(), 10u);
+  builder.push(42);
+  EXPECT_EQ(builder.finish().values(), std::vector<int>{42});
+}
+
+void test_merge()
+{
+  std::mt19937 gen(5);
+  for (size_t const na : {0, 1, 7, 100, 513})
+  {
+    for (size_t const nb : {0, 3, 64, 200})
+    {
+      std::vector<int> a(na), b(nb);
+      std::generate(a.begin(), a.end(), [&]{ return int(gen() % 1000); });
+      std::generate(b.begin(), b.end(), [&]{ return int(gen() % 1000); });
+      std::sort(a.begin(), a.end());
+      std::sort(b.begin(), b.end());
+      std::vector<int> expected;
+      std::merge(a.begin(), a.end(), b.begin(), b.end(), std::back_inserter(expected));
+
+      auto merged = merge_bsts(make_min_tree(a), make_min_tree(b));
+      EXPECT_EQ(merged.values(), expected);
+      EXPECT_EQ(merged.depth(), (expected.empty() ? 0 : size_t(std::log2(expected.size())) + 1));
+    }
+  }
 }
 
-int main()
+/**
+ * Build times for 10^7 sorted keys (or the count given after --bench), e.g. "--bench 100000000".
+ */
+void bench(int argc, char ** argv)
+{
+  size_t const n = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 10000000;
+  auto const input = make_input(n);
+
+  benchmark::report("make_min_tree (node per key)", n, benchmark::measure([&]
+  {
+    auto t = make_min_tree(input);
+    benchmark::do_not_optimize(t.root);
+  }));
+  for (unsigned const threads : {1u, 2u, 4u, 8u})
+  {
+    benchmark::report("make_min_tree_block " + std::to_string(threads) + " threads", n, benchmark::measure([&]
+    {
+      auto t = make_min_tree_block(input, threads);
+      benchmark::do_not_optimize(t.root);
+    }));
+  }
+  benchmark::report("make_min_tree_eytzinger", n, benchmark::measure([&]
+  {
+    auto t = make_min_tree_eytzinger(input);
+    benchmark::do_not_optimize(t.data());
+  }));
+  benchmark::report("make_min_tree (streamed)", n, benchmark::measure([&]
+  {
+    auto t = make_min_tree(input.begin(), input.end());
+    benchmark::do_not_optimize(t.root);
+  }));
+
+  // merge two interleaved halves: the odd and the even keys
+  std::vector<int> odd, even;
+  for (int const v : input) (v % 2 ? odd : even).push_back(v);
+  auto const a = make_min_tree(odd);
+  auto const b = make_min_tree(even);
+  benchmark::report("merge_bsts", n, benchmark::measure([&]
+  {
+    auto t = merge_bsts(a, b);
+    benchmark::do_not_optimize(t.root);
+  }));
+}
+
+int main(int argc, char ** argv)
 {
   test({});
   test({1});
@@ -69,5 +544,10 @@ int main()
   test(make_input(30));
   test(make_input(31));
   test(make_input(32));
+  test(make_input(1000));
+  test_streaming();
+  test_merge();
+
+  if (benchmark::requested(argc, argv)) bench(argc, argv);
   return testing::summary();
 }
@@ -2,7 +2,12 @@
 #include "List.hpp"
 #include "testing.hpp"
 #include "printing.hpp"
+#include "benchmark.hpp"
+#include "parallel.hpp"
 
+#include <vector>
+#include <string>
+#include <random>
 #include <cassert>
 
 namespace impl
@@ -45,13 +50,258 @@ std::vector<List<T>> make_level_lists(BinaryTree<T> const & tree)
   return result;
 }
 
+/**
+ * @brief All levels of a tree in one contiguous array, top to bottom and left to right within a level.
+ *
+ * Level d occupies items[offsets[d], offsets[d + 1]).
+ */
+template<typename V>
+struct LevelArrays
+{
+  std::vector<V> items;
+  std::vector<size_t> offsets{0};
+
+  [[nodiscard]] size_t levels() const
+  {
+    return offsets.size() - 1;
+  }
+
+  [[nodiscard]] V const * begin(size_t const level) const
+  {
+    return items.data() + offsets[level];
+  }
+
+  [[nodiscard]] V const * end(size_t const level) const
+  {
+    return items.data() + offsets[level + 1];
+  }
+};
+
+namespace impl
+{
+/**
+ * @brief Breadth-first walk that appends proj(node) for every node to the output, level by level.
+ *
+ * Only the current and next frontier of node pointers are kept. Levels at least @p min_parallel_width wide
+ * are split into chunks across @p num_threads threads: each chunk first counts the children of its nodes,
+ * a prefix sum over the counts gives every chunk its place in the next frontier, and then all chunks
+ * write their output items and children without further coordination.
+ */
+template<typename V, typename Node, typename Proj>
+LevelArrays<V> make_level_arrays(Node const * const root, Proj proj,
+                                 unsigned const num_threads, size_t const min_parallel_width)
+{
+  LevelArrays<V> res;
+  std::vector<Node const *> frontier;
+  std::vector<Node const *> next;
+  if (root) frontier.push_back(root);
+  std::vector<size_t> counts;
+  while (!frontier.empty())
+  {
+    size_t const width = frontier.size();
+    size_t const out = res.items.size();
+    res.items.resize(out + width);
+    res.offsets.push_back(out + width);
+
+    if (num_threads > 1 && width >= min_parallel_width)
+    {
+      counts.assign(num_threads + 1, 0);
+      parallel::for_chunks(width, num_threads, [&](unsigned const t, size_t const b, size_t const e)
+      {
+        size_t n = 0;
+        for (size_t i = b; i < e; ++i) n += (frontier[i]->left != nullptr) + (frontier[i]->right != nullptr);
+        counts[t + 1] = n;
+      });
+      for (size_t t = 1; t < counts.size(); ++t) counts[t] += counts[t - 1];
+      next.resize(counts.back());
+      parallel::for_chunks(width, num_threads, [&](unsigned const t, size_t const b, size_t const e)
+      {
+        size_t pos = counts[t];
+        for (size_t i = b; i < e; ++i)
+        {
+          Node const * const node = frontier[i];
+          res.items[out + i] = proj(node);
+          if (node->left) next[pos++] = node->left;
+          if (node->right) next[pos++] = node->right;
+        }
+      });
+    }
+    else
+    {
+      next.clear();
+      for (size_t i = 0; i < width; ++i)
+      {
+        Node const * const node = frontier[i];
+        res.items[out + i] = proj(node);
+        if (node->left) next.push_back(node->left);
+        if (node->right) next.push_back(node->right);
+      }
+    }
+    std::swap(frontier, next);
+  }
+  return res;
+}
+}
+
+/**
+ * @brief List of depths, as one contiguous array of values plus level offsets.
+ *
+ * Same levels as make_level_lists, but built breadth-first without a list node per tree node:
+ * the output is two arrays, and the only other memory is two frontiers as wide as the widest level.
+ * Levels wider than @p min_parallel_width are processed on up to @p num_threads threads.
+ * Time complexity: O(N) work.
+ * Space complexity: O(N) for the output, O(W) for the frontiers, where W is the width of the tree.
+ */
+template<typename T>
+LevelArrays<T> make_level_arrays(BinaryTree<T> const & tree,
+                                 unsigned const num_threads = parallel::default_threads(),
+                                 size_t const min_parallel_width = size_t{1} << 15)
+{
+  using Node = typename BinaryTree<T>::Node;
+  return impl::make_level_arrays<T>(static_cast<Node const *>(tree.root),
+                                    [](Node const * n) { return n->value; }, num_threads, min_parallel_width);
+}
+
+/**
+ * @brief List of depths holding pointers to the tree nodes themselves rather than copies of their values.
+ *
+ * Same as make_level_arrays otherwise.
+ */
+template<typename T>
+LevelArrays<typename BinaryTree<T>::Node const *> make_level_node_arrays(BinaryTree<T> const & tree,
+                                                                         unsigned const num_threads = parallel::default_threads(),
+                                                                         size_t const min_parallel_width = size_t{1} << 15)
+{
+  using Node = typename BinaryTree<T>::Node;
+  return impl::make_level_arrays<Node const *>(static_cast<Node const *>(tree.root),
+                                               [](Node const * n) { return n; }, num_threads, min_parallel_width);
+}
+
+/**
+ * The contiguous forms, sequential and parallel (forced on every level), must hold the same levels as the lists.
+ */
+void test_arrays(BinaryTree<int> const & tree, std::vector<List<int>> const & expected)
+{
+  for (unsigned const threads : {1u, 3u})
+  {
+    auto const arrays = make_level_arrays(tree, threads, 1);
+    auto const nodes = make_level_node_arrays(tree, threads, 1);
+    EXPECT_EQ(arrays.levels(), expected.size());
+    EXPECT_EQ(nodes.levels(), expected.size());
+    std::vector<List<int>> from_arrays;
+    std::vector<List<int>> from_nodes;
+    for (size_t d = 0; d < arrays.levels(); ++d)
+    {
+      from_arrays.emplace_back();
+      for (auto it = arrays.begin(d); it != arrays.end(d); ++it) from_arrays.back().add_tail(*it);
+      from_nodes.emplace_back();
+      for (auto it = nodes.begin(d); it != nodes.end(d); ++it) from_nodes.back().add_tail((*it)->value);
+    }
+    EXPECT_EQ(from_arrays, expected);
+    EXPECT_EQ(from_nodes, expected);
+  }
+}
+
 void test(BinaryTree<int> const & tree,
           std::vector<List<int>> const & expected)
 {
   EXPECT_EQ(make_level_lists(tree), expected);
+  test_arrays(tree, expected);
 }
 
-int main()
+/**
+ * @brief Random tree of @p n nodes valued 0..n-1, each attached below a random earlier node with a free child slot.
+ */
+BinaryTree<int> make_random_tree(size_t const n, unsigned const seed)
+{
+  using Node = BinaryTree<int>::Node;
+  BinaryTree<int> tree;
+  std::mt19937 gen(seed);
+  std::vector<Node *> open;
+  for (size_t i = 0; i < n; ++i)
+  {
+    Node * const node = new Node{ int(i), nullptr, nullptr };
+    if (!tree.root)
+    {
+      tree.root = node;
+    }
+    else
+    {
+      size_t const k = gen() % open.size();
+      Node * const parent = open[k];
+      Node * & slot = !parent->left && (parent->right || gen() % 2) ? parent->left : parent->right;
+      slot = node;
+      if (parent->left && parent->right)
+      {
+        open[k] = open.back();
+        open.pop_back();
+      }
+    }
+    open.push_back(node);
+  }
+  return tree;
+}
+
+/**
+ * @brief Perfect tree of 2^@p levels - 1 nodes, built level by level.
+ */
+BinaryTree<int> make_perfect_tree(size_t const levels)
+{
+  using Node = BinaryTree<int>::Node;
+  BinaryTree<int> tree;
+  if (levels == 0) return tree;
+  tree.root = new Node{ 0, nullptr, nullptr };
+  std::vector<Node *> frontier{ tree.root };
+  std::vector<Node *> next;
+  int value = 1;
+  for (size_t d = 1; d < levels; ++d)
+  {
+    next.clear();
+    for (Node * const node : frontier)
+    {
+      node->left = new Node{ value++, nullptr, nullptr };
+      node->right = new Node{ value++, nullptr, nullptr };
+      next.push_back(node->left);
+      next.push_back(node->right);
+    }
+    std::swap(frontier, next);
+  }
+  return tree;
+}
+
+/**
+ * Level lists against level arrays on a perfect tree with 2^22 - 1 nodes and a random tree of as many.
+ */
+void bench()
+{
+  auto const run = [](std::string const & name, BinaryTree<int> const & tree)
+  {
+    size_t const n = tree.size();
+    benchmark::report("make_level_lists " + name, n, benchmark::measure([&]
+    {
+      auto lists = make_level_lists(tree);
+      benchmark::do_not_optimize(lists.data());
+    }));
+    for (unsigned const threads : {1u, 2u, 4u})
+    {
+      benchmark::report("make_level_arrays " + name + " " + std::to_string(threads) + " threads", n,
+                        benchmark::measure([&]
+      {
+        auto arrays = make_level_arrays(tree, threads);
+        benchmark::do_not_optimize(arrays.items.data());
+      }));
+    }
+    benchmark::report("make_level_node_arrays " + name, n, benchmark::measure([&]
+    {
+      auto arrays = make_level_node_arrays(tree, 1);
+      benchmark::do_not_optimize(arrays.items.data());
+    }));
+  };
+  run("perfect", make_perfect_tree(22));
+  run("random", make_random_tree((size_t{1} << 22) - 1, 1));
+}
+
+int main(int argc, char ** argv)
 {
   test({}, {});
   test({{0,-1,-1,0}}, {{0}});
@@ -59,5 +309,13 @@ int main()
   test({{0,1,2,0},{1,-1,-1,1},{2,3,-1,2},{3,-1,-1,3}}, {{0},{1,2},{3}});
   test({{0,1,2,0},{1,-1,4,1},{2,3,-1,2},{3,-1,-1,3},{4,-1,-1,4}}, {{0},{1,2},{4,3}});
   test({{0,1,2,0},{1,-1,4,1},{2,3,-1,2},{3,-1,5,3},{4,-1,-1,4},{5,-1,-1,5}}, {{0},{1,2},{4,3},{5}});
+  for (unsigned seed = 0; seed < 20; ++seed)
+  {
+    auto const tree = make_random_tree(seed * 50, seed);
+    test_arrays(tree, make_level_lists(tree));
+  }
+  test_arrays(make_perfect_tree(10), make_level_lists(make_perfect_tree(10)));
+
+  if (benchmark::requested(argc, argv)) bench();
   return testing::summary();
 }
@@ -0,0 +1,420 @@
+#ifndef CTCI_SOLUTIONS_BIGINT_HPP
+#define CTCI_SOLUTIONS_BIGINT_HPP
+
+#include "List.hpp"
+
+#include <vector>
+#include <string>
+#include <ostream>
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <cstddef>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#include <immintrin.h>
+#define CTCI_SOLUTIONS_HAS_ADDCARRY 1
+#endif
+
+namespace bigint
+{
+using limb_t = std::uint64_t;
+
+// multiplication switches from schoolbook to Karatsuba at this many limbs (4 at the very least)
+inline size_t karatsuba_threshold = 32;
+
+inline unsigned char addcarry(unsigned char c, limb_t a, limb_t b, limb_t * out)
+{
+#ifdef CTCI_SOLUTIONS_HAS_ADDCARRY
+  unsigned long long r;
+  c = _addcarry_u64(c, a, b, &r);
+  *out = r;
+  return c;
+#else
+  limb_t const s = a + b;
+  limb_t const r = s + c;
+  *out = r;
+  return (s < a) | (r < s);
+#endif
+}
+
+inline unsigned char subborrow(unsigned char c, limb_t a, limb_t b, limb_t * out)
+{
+#ifdef CTCI_SOLUTIONS_HAS_ADDCARRY
+  unsigned long long r;
+  c = _subborrow_u64(c, a, b, &r);
+  *out = r;
+  return c;
+#else
+  limb_t const d = a - b;
+  limb_t const r = d - c;
+  *out = r;
+  return (a < b) | (d < c);
+#endif
+}
+
+/**
+ * @brief r[0..na) = a[0..na) + b[0..nb), requires na >= nb; returns carry out.
+ */
+inline limb_t add(limb_t * r, limb_t const * a, size_t na, limb_t const * b, size_t nb)
+{
+  assert(na >= nb);
+  unsigned char c = 0;
+  size_t i = 0;
+  for (; i < nb; ++i) c = addcarry(c, a[i], b[i], &r[i]);
+  for (; i < na; ++i) c = addcarry(c, a[i], 0, &r[i]);
+  return c;
+}
+
+/**
+ * @brief r[0..na) = a[0..na) - b[0..nb), requires na >= nb; returns borrow out.
+ */
+inline limb_t sub(limb_t * r, limb_t const * a, size_t na, limb_t const * b, size_t nb)
+{
+  assert(na >= nb);
+  unsigned char c = 0;
+  size_t i = 0;
+  for (; i < nb; ++i) c = subborrow(c, a[i], b[i], &r[i]);
+  for (; i < na; ++i) c = subborrow(c, a[i], 0, &r[i]);
+  return c;
+}
+
+/**
+ * @brief r[0..na+nb) = a * b using the O(na*nb) schoolbook method.
+ */
+inline void mul_schoolbook(limb_t * r, limb_t const * a, size_t na, limb_t const * b, size_t nb)
+{
+  std::fill(r, r + na + nb, 0);
+  for (size_t j = 0; j < nb; ++j)
+  {
+    limb_t carry = 0;
+    for (size_t i = 0; i < na; ++i)
+    {
+      unsigned __int128 const t = static_cast<unsigned __int128>(a[i]) * b[j] + r[i + j] + carry;
+      r[i + j] = static_cast<limb_t>(t);
+      carry = static_cast<limb_t>(t >> 64);
+    }
+    r[na + j] = carry;
+  }
+}
+
+inline void mul(limb_t * r, limb_t const * a, size_t na, limb_t const * b, size_t nb);
+
+/**
+ * @brief r[0..2n) = a * b for equal-length operands using Karatsuba's method.
+ *
+ * With a = a1*B^m + a0 and b = b1*B^m + b0:
+ * a*b = z2*B^2m + (z1 - z2 - z0)*B^m + z0, where z0 = a0*b0, z2 = a1*b1, z1 = (a0+a1)*(b0+b1).
+ */
+inline void mul_karatsuba(limb_t * r, limb_t const * a, limb_t const * b, size_t n)
+{
+  size_t const m = n / 2;
+  size_t const h = n - m;
+
+  // z0 goes to r[0..2m), z2 goes to r[2m..2n)
+  mul(r, a, m, b, m);
+  mul(r + 2 * m, a + m, h, b + m, h);
+
+  std::vector<limb_t> sa(h + 1), sb(h + 1), z1(2 * h + 2);
+  sa[h] = add(sa.data(), a + m, h, a, m);
+  sb[h] = add(sb.data(), b + m, h, b, m);
+  mul(z1.data(), sa.data(), h + 1, sb.data(), h + 1);
+  [[maybe_unused]] limb_t borrow = sub(z1.data(), z1.data(), z1.size(), r, 2 * m);
+  borrow |= sub(z1.data(), z1.data(), z1.size(), r + 2 * m, 2 * h);
+  assert(borrow == 0);
+
+  // add the middle term at offset m; it can't overflow the full product
+  size_t len = z1.size();
+  while (len > 0 && z1[len - 1] == 0) --len;
+  [[maybe_unused]] limb_t const carry = add(r + m, r + m, 2 * n - m, z1.data(), std::min(len, 2 * n - m));
+  assert(carry == 0);
+}
+
+/**
+ * @brief r[0..na+nb) = a * b, picking the algorithm by operand size.
+ *
+ * Unbalanced operands are multiplied in slices of the shorter length.
+ */
+inline void mul(limb_t * r, limb_t const * a, size_t na, limb_t const * b, size_t nb)
+{
+  if (na < nb)
+  {
+    std::swap(a, b);
+    std::swap(na, nb);
+  }
+  if (nb < std::max<size_t>(4, karatsuba_threshold))
+  {
+    mul_schoolbook(r, a, na, b, nb);
+  }
+  else if (na == nb)
+  {
+    mul_karatsuba(r, a, b, na);
+  }
+  else
+  {
+    std::fill(r, r + na + nb, 0);
+    std::vector<limb_t> tmp(2 * nb);
+    for (size_t i = 0; i < na; i += nb)
+    {
+      size_t const len = std::min(nb, na - i);
+      mul(tmp.data(), a + i, len, b, nb);
+      add(r + i, r + i, na + nb - i, tmp.data(), len + nb);
+    }
+  }
+}
+
+/**
+ * @brief Divide in place by a single limb; returns the remainder.
+ */
+inline limb_t divmod(limb_t * a, size_t n, limb_t d)
+{
+  unsigned __int128 rem = 0;
+  for (size_t i = n; i-- > 0;)
+  {
+    unsigned __int128 const cur = (rem << 64) | a[i];
+    a[i] = static_cast<limb_t>(cur / d);
+    rem = cur % d;
+  }
+  return static_cast<limb_t>(rem);
+}
+
+} // namespace bigint
+
+/**
+ * @brief Arbitrary-precision unsigned integer
+ *
+ * Stored as contiguous little-endian 64-bit limbs with no high zero limbs (zero has none).
+ * Supports addition, subtraction (of a smaller number), multiplication and comparison,
+ * and conversions to/from decimal strings and digit-per-node FwdList form.
+ */
+class BigUInt
+{
+public:
+
+  using limb_t = bigint::limb_t;
+
+  BigUInt() = default;
+
+  BigUInt(limb_t v)
+  {
+    if (v) m_limbs.push_back(v);
+  }
+
+  explicit BigUInt(std::vector<limb_t> limbs) : m_limbs(std::move(limbs))
+  {
+    trim();
+  }
+
+  /**
+   * @brief Parse decimal digits, most significant first.
+   */
+  explicit BigUInt(std::string const & digits)
+  {
+    std::vector<unsigned char> msd_first;
+    msd_first.reserve(digits.size());
+    for (char c : digits)
+    {
+      assert(c >= '0' && c <= '9');
+      msd_first.push_back(static_cast<unsigned char>(c - '0'));
+    }
+    *this = from_digits(msd_first.rbegin(), msd_first.rend());
+  }
+
+  /**
+   * @brief Build from decimal digits given least significant first.
+   *
+   * Digits are packed into base 10^19 words, which are then combined pairwise, level by level:
+   * value = high * 10^(19 * 2^k) + low. With Karatsuba multiplication this is subquadratic.
+   */
+  template <typename Iter>
+  static BigUInt from_digits(Iter first, Iter last)
+  {
+    std::vector<BigUInt> parts;
+    while (first != last)
+    {
+      limb_t word = 0;
+      limb_t scale = 1;
+      for (int i = 0; i < chunk_digits && first != last; ++i, ++first)
+      {
+        word += static_cast<limb_t>(*first) * scale;
+        scale *= 10;
+      }
+      parts.emplace_back(word);
+    }
+    BigUInt power = chunk_base;
+    while (parts.size() > 1)
+    {
+      std::vector<BigUInt> next;
+      next.reserve((parts.size() + 1) / 2);
+      for (size_t i = 0; i + 1 < parts.size(); i += 2)
+      {
+        next.push_back(parts[i + 1] * power + parts[i]);
+      }
+      if (parts.size() % 2 == 1) next.push_back(std::move(parts.back()));
+      parts = std::move(next);
+      if (parts.size() > 1) power = power * power;
+    }
+    return parts.empty() ? BigUInt{} : std::move(parts.front());
+  }
+
+  /**
+   * @brief Decimal digits, least significant first (a single 0 for zero).
+   *
+   * Repeated division by 10^19: quadratic, so meant for I/O rather than hot paths.
+   */
+  [[nodiscard]]
+  std::vector<unsigned char> to_digits() const
+  {
+    std::vector<unsigned char> digits;
+    std::vector<limb_t> tmp = m_limbs;
+    size_t n = tmp.size();
+    while (n > 0)
+    {
+      limb_t word = bigint::divmod(tmp.data(), n, chunk_base);
+      while (n > 0 && tmp[n - 1] == 0) --n;
+      for (int i = 0; i < chunk_digits && (n > 0 || word > 0); ++i, word /= 10)
+      {
+        digits.push_back(static_cast<unsigned char>(word % 10));
+      }
+    }
+    if (digits.empty()) digits.push_back(0);
+    return digits;
+  }
+
+  [[nodiscard]]
+  std::string to_string() const
+  {
+    auto const digits = to_digits();
+    std::string s;
+    s.reserve(digits.size());
+    for (auto it = digits.rbegin(); it != digits.rend(); ++it) s.push_back(char('0' + *it));
+    return s;
+  }
+
+  /**
+   * @brief Convert from a list of digits, least significant first (as in sum_lists_reverse).
+   */
+  template <typename T>
+  static BigUInt from_list_reverse(FwdList<T> const & l)
+  {
+    std::vector<unsigned char> digits;
+    for (auto n = l.head; n; n = n->next) digits.push_back(static_cast<unsigned char>(n->val));
+    return from_digits(digits.begin(), digits.end());
+  }
+
+  /**
+   * @brief Convert from a list of digits, most significant first (as in sum_lists_forward).
+   */
+  template <typename T>
+  static BigUInt from_list_forward(FwdList<T> const & l)
+  {
+    std::vector<unsigned char> digits;
+    for (auto n = l.head; n; n = n->next) digits.push_back(static_cast<unsigned char>(n->val));
+    return from_digits(digits.rbegin(), digits.rend());
+  }
+
+  template <typename T>
+  [[nodiscard]]
+  FwdList<T> to_list_reverse() const
+  {
+    auto const digits = to_digits();
+    return make_list<T>(digits.begin(), digits.end());
+  }
+
+  template <typename T>
+  [[nodiscard]]
+  FwdList<T> to_list_forward() const
+  {
+    auto const digits = to_digits();
+    return make_list<T>(digits.rbegin(), digits.rend());
+  }
+
+  [[nodiscard]] std::vector<limb_t> const & limbs() const { return m_limbs; }
+  [[nodiscard]] bool is_zero() const { return m_limbs.empty(); }
+
+  friend BigUInt operator+(BigUInt const & a, BigUInt const & b)
+  {
+    BigUInt const & l = a.m_limbs.size() >= b.m_limbs.size() ? a : b;
+    BigUInt const & s = a.m_limbs.size() >= b.m_limbs.size() ? b : a;
+    BigUInt r;
+    r.m_limbs.resize(l.m_limbs.size() + 1);
+    r.m_limbs.back() = bigint::add(r.m_limbs.data(), l.m_limbs.data(), l.m_limbs.size(), s.m_limbs.data(), s.m_limbs.size());
+    r.trim();
+    return r;
+  }
+
+  /**
+   * @brief Difference of two numbers; requires a >= b.
+   */
+  friend BigUInt operator-(BigUInt const & a, BigUInt const & b)
+  {
+    assert(!(a < b));
+    BigUInt r;
+    r.m_limbs.resize(a.m_limbs.size());
+    [[maybe_unused]] auto const borrow = bigint::sub(r.m_limbs.data(), a.m_limbs.data(), a.m_limbs.size(), b.m_limbs.data(), b.m_limbs.size());
+    assert(borrow == 0);
+    r.trim();
+    return r;
+  }
+
+  friend BigUInt operator*(BigUInt const & a, BigUInt const & b)
+  {
+    if (a.is_zero() || b.is_zero()) return {};
+    BigUInt r;
+    r.m_limbs.resize(a.m_limbs.size() + b.m_limbs.size());
+    bigint::mul(r.m_limbs.data(), a.m_limbs.data(), a.m_limbs.size(), b.m_limbs.data(), b.m_limbs.size());
+    r.trim();
+    return r;
+  }
+
+  friend bool operator==(BigUInt const & a, BigUInt const & b)
+  {
+    return a.m_limbs == b.m_limbs;
+  }
+
+  friend bool operator!=(BigUInt const & a, BigUInt const & b)
+  {
+    return !(a == b);
+  }
+
+  friend bool operator<(BigUInt const & a, BigUInt const & b)
+  {
+    if (a.m_limbs.size() != b.m_limbs.size()) return a.m_limbs.size() < b.m_limbs.size();
+    return std::lexicographical_compare(a.m_limbs.rbegin(), a.m_limbs.rend(), b.m_limbs.rbegin(), b.m_limbs.rend());
+  }
+
+  friend std::ostream & operator<<(std::ostream & os, BigUInt const & v)
+  {
+    os << v.to_string();
+    return os;
+  }
+
+private:
+
+  static constexpr int chunk_digits = 19;
+  static constexpr limb_t chunk_base = 10'000'000'000'000'000'000ULL;
+
+  template <typename T, typename Iter>
+  static FwdList<T> make_list(Iter first, Iter last)
+  {
+    using Node = typename FwdList<T>::Node;
+    FwdList<T> l;
+    Node * prev = nullptr;
+    for (; first != last; ++first)
+    {
+      Node * const node = new Node{ nullptr, static_cast<T>(*first) };
+      (prev ? prev->next : l.head) = node;
+      prev = node;
+    }
+    return l;
+  }
+
+  void trim()
+  {
+    while (!m_limbs.empty() && m_limbs.back() == 0) m_limbs.pop_back();
+  }
+
+  std::vector<limb_t> m_limbs;
+};
+
+#endif //CTCI_SOLUTIONS_BIGINT_HPP
@@ -0,0 +1,327 @@
+#ifndef CTCI_SOLUTIONS_CONCURRENTQUEUE_HPP
+#define CTCI_SOLUTIONS_CONCURRENTQUEUE_HPP
+
+#include <atomic>
+#include <memory>
+#include <optional>
+#include <utility>
+#include <type_traits>
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+
+namespace concurrent
+{
+  inline constexpr size_t cache_line_size = 64;
+
+  inline size_t round_up_pow2(size_t n)
+  {
+    size_t p = 1;
+    while (p < n) p <<= 1;
+    return p;
+  }
+}
+
+/**
+ * @brief Bounded single-producer/single-consumer queue over a ring buffer
+ *
+ * The producer owns the tail index and the consumer owns the head index; each sits on its own
+ * cache line, next to that thread's cached copy of the other index, so the two threads only
+ * exchange cache lines when the cached copy says the queue looks full (or empty).
+ * Capacity is rounded up to a power of two. Exactly one thread may push and one may pop.
+ * T must be default-constructible and move-assignable.
+ */
+template <typename T>
+class SpscQueue
+{
+public:
+
+  explicit SpscQueue(size_t capacity)
+  : m_mask(concurrent::round_up_pow2(std::max<size_t>(2, capacity)) - 1),
+    m_buf(new T[m_mask + 1])
+  {}
+
+  SpscQueue(SpscQueue const &) = delete;
+  SpscQueue & operator=(SpscQueue const &) = delete;
+
+  /**
+   * @brief Push a value; @p val is moved from only if the push succeeds, so it can be retried.
+   * @return false if the queue is full
+   */
+  template <typename U>
+  bool try_push(U && val)
+  {
+    size_t const tail = m_prod.index.load(std::memory_order_relaxed);
+    if (tail - m_prod.cached == capacity())
+    {
+      m_prod.cached = m_cons.index.load(std::memory_order_acquire);
+      if (tail - m_prod.cached == capacity()) return false;
+    }
+    m_buf[tail & m_mask] = std::forward<U>(val);
+    m_prod.index.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+  /**
+   * @brief Push as many of the @p n values at @p first as fit, publishing them at once.
+   * @return number of values pushed
+   */
+  template <typename It>
+  size_t try_push_n(It first, size_t n)
+  {
+    size_t const tail = m_prod.index.load(std::memory_order_relaxed);
+    if (capacity() - (tail - m_prod.cached) < n) m_prod.cached = m_cons.index.load(std::memory_order_acquire);
+    size_t const k = std::min(n, capacity() - (tail - m_prod.cached));
+    for (size_t i = 0; i < k; ++i, ++first) m_buf[(tail + i) & m_mask] = std::move(*first);
+    m_prod.index.store(tail + k, std::memory_order_release);
+    return k;
+  }
+
+  /**
+   * @return false if the queue is empty
+   */
+  bool try_pop(T & out)
+  {
+    size_t const head = m_cons.index.load(std::memory_order_relaxed);
+    if (head == m_cons.cached)
+    {
+      m_cons.cached = m_prod.index.load(std::memory_order_acquire);
+      if (head == m_cons.cached) return false;
+    }
+    out = std::move(m_buf[head & m_mask]);
+    m_cons.index.store(head + 1, std::memory_order_release);
+    return true;
+  }
+
+  /**
+   * @brief Pop up to @p n values into @p out, releasing their slots at once.
+   * @return number of values popped
+   */
+  template <typename It>
+  size_t try_pop_n(It out, size_t n)
+  {
+    size_t const head = m_cons.index.load(std::memory_order_relaxed);
+    if (m_cons.cached - head < n) m_cons.cached = m_prod.index.load(std::memory_order_acquire);
+    size_t const k = std::min(n, m_cons.cached - head);
+    for (size_t i = 0; i < k; ++i, ++out) *out = std::move(m_buf[(head + i) & m_mask]);
+    m_cons.index.store(head + k, std::memory_order_release);
+    return k;
+  }
+
+  [[nodiscard]]
+  size_t capacity() const
+  {
+    return m_mask + 1;
+  }
+
+  /**
+   * @brief Number of values in the queue; exact only when neither end is being modified.
+   */
+  [[nodiscard]]
+  size_t size() const
+  {
+    return m_prod.index.load() - m_cons.index.load();
+  }
+
+private:
+
+  struct alignas(concurrent::cache_line_size) End
+  {
+    std::atomic<size_t> index{0};
+    size_t cached{0}; // this end's last observation of the other end's index
+  };
+
+  End m_prod;
+  End m_cons;
+  size_t const m_mask;
+  std::unique_ptr<T[]> m_buf;
+};
+
+/**
+ * @brief Bounded multi-producer/multi-consumer queue (Dmitry Vyukov's design)
+ *
+ * Every cell carries a sequence number that says whose turn it is: a cell at position p is free
+ * for the producer claiming p when its sequence equals p, and holds a value for the consumer
+ * claiming p when it equals p + 1. A thread claims a position with one CAS on the shared enqueue
+ * (or dequeue) counter, then owns the cell without further synchronization, and hands it on by
+ * advancing the sequence (to p + 1 after a push, to p + capacity after a pop).
+ * Batch operations claim a run of consecutive ready cells with a single CAS.
+ * Producers and consumers never block each other except through a full or empty queue.
+ * Capacity is rounded up to a power of two. T must be default-constructible and move-assignable.
+ */
+template <typename T>
+class MpmcQueue
+{
+public:
+
+  explicit MpmcQueue(size_t capacity)
+  : m_mask(concurrent::round_up_pow2(std::max<size_t>(2, capacity)) - 1),
+    m_cells(new Cell[m_mask + 1])
+  {
+    for (size_t i = 0; i <= m_mask; ++i) m_cells[i].seq.store(i, std::memory_order_relaxed);
+  }
+
+  MpmcQueue(MpmcQueue const &) = delete;
+  MpmcQueue & operator=(MpmcQueue const &) = delete;
+
+  /**
+   * @brief Push a value; @p val is moved from only if the push succeeds, so it can be retried.
+   * @return false if the queue is full
+   */
+  template <typename U>
+  bool try_push(U && val)
+  {
+    size_t pos = m_enqueue.pos.load(std::memory_order_relaxed);
+    if (claim(m_enqueue, pos, 1, 0) == 0) return false;
+    Cell & cell = m_cells[pos & m_mask];
+    cell.value = std::forward<U>(val);
+    cell.seq.store(pos + 1, std::memory_order_release);
+    return true;
+  }
+
+  /**
+   * @brief Push up to @p n values from @p first into consecutive cells claimed at once.
+   * @return number of values pushed (fewer than n if the queue filled up)
+   */
+  template <typename It>
+  size_t try_push_n(It first, size_t n)
+  {
+    size_t pos = m_enqueue.pos.load(std::memory_order_relaxed);
+    size_t const k = claim(m_enqueue, pos, n, 0);
+    for (size_t i = 0; i < k; ++i, ++first)
+    {
+      Cell & cell = m_cells[(pos + i) & m_mask];
+      cell.value = std::move(*first);
+      cell.seq.store(pos + i + 1, std::memory_order_release);
+    }
+    return k;
+  }
+
+  /**
+   * @return false if the queue is empty
+   */
+  bool try_pop(T & out)
+  {
+    size_t pos = m_dequeue.pos.load(std::memory_order_relaxed);
+    if (claim(m_dequeue, pos, 1, 1) == 0) return false;
+    Cell & cell = m_cells[pos & m_mask];
+    out = std::move(cell.value);
+    cell.seq.store(pos + m_mask + 1, std::memory_order_release);
+    return true;
+  }
+
+  /**
+   * @brief Pop up to @p n values into @p out from consecutive cells claimed at once.
+   * @return number of values popped
+   */
+  template <typename It>
+  size_t try_pop_n(It out, size_t n)
+  {
+    size_t pos = m_dequeue.pos.load(std::memory_order_relaxed);
+    size_t const k = claim(m_dequeue, pos, n, 1);
+    for (size_t i = 0; i < k; ++i, ++out)
+    {
+      Cell & cell = m_cells[(pos + i) & m_mask];
+      *out = std::move(cell.value);
+      cell.seq.store(pos + i + m_mask + 1, std::memory_order_release);
+    }
+    return k;
+  }
+
+  /**
+   * @brief Apply @p key to the value at the front without removing it (seqlock-style read).
+   *
+   * The front cell is read optimistically and the read is retried if a consumer claimed the cell
+   * meanwhile, so @p key may run on a value that is being moved out concurrently: it must only read
+   * parts of the value that are safe to read during a move, such as std::atomic members, and should load
+   * them with acquire ordering so that the re-check that follows cannot be reordered before them.
+   * @return the key, or nothing if the queue is empty
+   */
+  template <typename F>
+  auto try_peek(F && key) const -> std::optional<std::decay_t<decltype(key(std::declval<T const &>()))>>
+  {
+    for (;;)
+    {
+      size_t const pos = m_dequeue.pos.load(std::memory_order_acquire);
+      Cell const & cell = m_cells[pos & m_mask];
+      if (cell.seq.load(std::memory_order_acquire) != pos + 1)
+      {
+        if (m_dequeue.pos.load(std::memory_order_acquire) == pos) return std::nullopt;
+        continue;
+      }
+      auto k = key(cell.value);
+      if (cell.seq.load(std::memory_order_acquire) == pos + 1 && m_dequeue.pos.load(std::memory_order_acquire) == pos)
+      {
+        return k;
+      }
+    }
+  }
+
+  [[nodiscard]]
+  size_t capacity() const
+  {
+    return m_mask + 1;
+  }
+
+  /**
+   * @brief Number of values in the queue; approximate while other threads are active.
+   */
+  [[nodiscard]]
+  size_t size() const
+  {
+    size_t const tail = m_enqueue.pos.load();
+    size_t const head = m_dequeue.pos.load();
+    return tail > head ? tail - head : 0;
+  }
+
+private:
+
+  struct Cell
+  {
+    std::atomic<size_t> seq;
+    T value{};
+  };
+
+  // producers and consumers each contend on their own cache line
+  struct alignas(concurrent::cache_line_size) Counter
+  {
+    std::atomic<size_t> pos{0};
+  };
+
+  /**
+   * @brief Claim up to @p n consecutive positions starting at @p pos from @p counter.
+   *
+   * A position p is ready when its cell's sequence is p + @p lag (0 for producers, 1 for consumers).
+   * On return, @p pos is the first claimed position.
+   * @return number of claimed positions, 0 if the first one is not ready (queue full or empty)
+   */
+  size_t claim(Counter & counter, size_t & pos, size_t const n, size_t const lag)
+  {
+    for (;;)
+    {
+      size_t k = 0;
+      for (; k < n && k <= m_mask; ++k)
+      {
+        size_t const seq = m_cells[(pos + k) & m_mask].seq.load(std::memory_order_acquire);
+        if (seq != pos + k + lag) break;
+      }
+      if (k == 0)
+      {
+        // either the queue is full/empty, or another thread claimed pos already
+        size_t const seq = m_cells[pos & m_mask].seq.load(std::memory_order_acquire);
+        size_t const now = counter.pos.load(std::memory_order_relaxed);
+        if (static_cast<std::ptrdiff_t>(seq - (pos + lag)) < 0 && now == pos) return 0;
+        pos = now;
+        continue;
+      }
+      if (counter.pos.compare_exchange_weak(pos, pos + k, std::memory_order_relaxed)) return k;
+    }
+  }
+
+  Counter m_enqueue;
+  Counter m_dequeue;
+  size_t const m_mask;
+  std::unique_ptr<Cell[]> m_cells;
+};
+
+#endif //CTCI_SOLUTIONS_CONCURRENTQUEUE_HPP
@@ -0,0 +1,174 @@
+#ifndef CTCI_SOLUTIONS_EPOCH_HPP
+#define CTCI_SOLUTIONS_EPOCH_HPP
+
+#include <atomic>
+#include <array>
+#include <thread>
+#include <functional>
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * Epoch-based memory reclamation for lock-free structures.
+ *
+ * Threads wrap every access to shared nodes in a Guard, which announces the global epoch
+ * the thread observed. A node that has been unlinked is retire()d instead of deleted;
+ * it is freed only after the global epoch has advanced twice past its retirement,
+ * which can happen only once every thread that might still hold a pointer to it has left its guard.
+ */
+namespace epoch
+{
+  /**
+   * @brief Reclamation domain for nodes of type Node.
+   *
+   * Node must provide two intrusive fields used while it waits to be freed:
+   * `Node * retired_next` and `std::uint64_t retired_epoch`.
+   * At most MaxGuards guards may be active at the same time (further ones spin until a slot frees up).
+   */
+  template <typename Node, size_t MaxGuards = 128>
+  class Domain
+  {
+  public:
+
+    class Guard
+    {
+    public:
+
+      explicit Guard(Domain & d) : m_domain(d), m_slot(d.enter()) {}
+      ~Guard() { m_domain.leave(m_slot); }
+
+      Guard(Guard const &) = delete;
+      Guard & operator=(Guard const &) = delete;
+
+    private:
+
+      Domain & m_domain;
+      size_t m_slot;
+    };
+
+    Domain() = default;
+
+    Domain(Domain const &) = delete;
+    Domain & operator=(Domain const &) = delete;
+
+    /**
+     * @brief Free all retired nodes. Must not be called while other threads use the domain.
+     */
+    ~Domain()
+    {
+      free_list(m_retired.exchange(nullptr));
+    }
+
+    /**
+     * @brief Schedule an unlinked node for deletion once no guard can still reference it.
+     */
+    void retire(Node * node)
+    {
+      node->retired_epoch = m_global.load();
+      push_retired(node, node);
+      try_reclaim();
+    }
+
+  private:
+
+    static constexpr std::uint64_t inactive = ~std::uint64_t{0};
+
+    struct alignas(64) Slot
+    {
+      std::atomic<bool> in_use{false};
+      std::atomic<std::uint64_t> epoch{inactive};
+    };
+
+    size_t enter()
+    {
+      size_t i = std::hash<std::thread::id>{}(std::this_thread::get_id()) % MaxGuards;
+      for (bool expected = false; !m_slots[i].in_use.compare_exchange_weak(expected, true); expected = false)
+      {
+        if (++i == MaxGuards)
+        {
+          i = 0;
+          std::this_thread::yield();
+        }
+      }
+      // re-read until the announced epoch is current, so a stale announcement can't be outrun
+      for (;;)
+      {
+        std::uint64_t const e = m_global.load();
+        m_slots[i].epoch.store(e);
+        if (m_global.load() == e) return i;
+      }
+    }
+
+    void leave(size_t i)
+    {
+      m_slots[i].epoch.store(inactive);
+      m_slots[i].in_use.store(false, std::memory_order_release);
+    }
+
+    /**
+     * @brief Advance the epoch if every active guard has caught up with it, then free old nodes.
+     */
+    void try_reclaim()
+    {
+      std::uint64_t const e = m_global.load();
+      bool caught_up = true;
+      for (auto const & s : m_slots)
+      {
+        std::uint64_t const se = s.epoch.load();
+        if (se != inactive && se != e)
+        {
+          caught_up = false;
+          break;
+        }
+      }
+      std::uint64_t expected = e;
+      if (caught_up) m_global.compare_exchange_strong(expected, e + 1);
+
+      std::uint64_t const now = m_global.load();
+      Node * keep_first = nullptr;
+      Node * keep_last = nullptr;
+      for (Node * n = m_retired.exchange(nullptr); n;)
+      {
+        Node * const next = n->retired_next;
+        if (n->retired_epoch + 2 <= now)
+        {
+          delete n;
+        }
+        else
+        {
+          n->retired_next = keep_first;
+          keep_first = n;
+          if (!keep_last) keep_last = n;
+        }
+        n = next;
+      }
+      if (keep_first) push_retired(keep_first, keep_last);
+    }
+
+    void push_retired(Node * first, Node * last)
+    {
+      Node * head = m_retired.load();
+      do
+      {
+        last->retired_next = head;
+      }
+      while (!m_retired.compare_exchange_weak(head, first));
+    }
+
+    static void free_list(Node * n)
+    {
+      while (n)
+      {
+        Node * const next = n->retired_next;
+        delete n;
+        n = next;
+      }
+    }
+
+    std::atomic<std::uint64_t> m_global{0};
+    std::atomic<Node *> m_retired{nullptr};
+    std::array<Slot, MaxGuards> m_slots{};
+  };
+}
+
+#endif //CTCI_SOLUTIONS_EPOCH_HPP
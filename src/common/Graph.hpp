@@ -4,6 +4,7 @@
 #include <vector>
 #include <tuple>
 #include <cstdint>
+#include <cstddef>
 #include <numeric>
 
 /**
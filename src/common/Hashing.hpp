@@ -0,0 +1,390 @@
+#ifndef CTCI_SOLUTIONS_HASHING_HPP
+#define CTCI_SOLUTIONS_HASHING_HPP
+
+#include <vector>
+#include <algorithm>
+#include <utility>
+#include <functional>
+#include <cstdint>
+#include <cstddef>
+
+namespace hashing
+{
+
+/**
+ * @brief 64-bit finalizer from MurmurHash3.
+ *
+ * std::hash for integers and pointers is usually the identity, which makes
+ * low bits of sequential keys collide in power-of-two tables. Mixing fixes that.
+ */
+inline std::uint64_t mix(std::uint64_t h)
+{
+  h ^= h >> 33;
+  h *= 0xff51afd7ed558ccdULL;
+  h ^= h >> 33;
+  h *= 0xc4ceb9fe1a85ec53ULL;
+  h ^= h >> 33;
+  return h;
+}
+
+inline size_t next_pow2(size_t n)
+{
+  size_t p = 1;
+  while (p < n) p <<= 1;
+  return p;
+}
+
+/**
+ * @brief Control byte of an occupied slot: high bit set plus top 7 bits of the hash.
+ */
+inline std::uint8_t tag(std::uint64_t h)
+{
+  return static_cast<std::uint8_t>(0x80 | (h >> 57));
+}
+
+/**
+ * @brief Key of a set slot: the value itself.
+ */
+struct Identity
+{
+  template <typename T>
+  T const & operator()(T const & v) const
+  {
+    return v;
+  }
+};
+
+/**
+ * @brief Key of a map slot: the first member of the pair.
+ */
+struct First
+{
+  template <typename P>
+  auto const & operator()(P const & p) const
+  {
+    return p.first;
+  }
+};
+
+/**
+ * @brief Open-addressing table with linear probing, shared by FlatHashSet and FlatHashMap.
+ *
+ * Slots are stored inline in a single array, with a parallel array of control bytes
+ * (0 for empty slot, otherwise high bit plus 7 bits of the hash to skip most key comparisons).
+ * Capacity is a power of two and the load factor is kept at or below 1/2. No erase.
+ * KeyOf extracts the Key from a Slot.
+ */
+template <typename Slot, typename Key, typename KeyOf, typename Hash, typename KeyEqual>
+class FlatTable
+{
+public:
+
+  /**
+   * @brief Make room for @p n slots without rehashing.
+   */
+  void reserve(size_t n)
+  {
+    size_t const cap = next_pow2(2 * n);
+    if (n > 0 && cap > m_ctrl.size()) rehash(cap);
+  }
+
+  /**
+   * @brief Store make() unless a slot with @p key is present, probing the table once.
+   * @return pointer to the slot with @p key and whether insertion took place
+   */
+  template <typename MakeSlot>
+  std::pair<Slot *, bool> emplace(Key const & key, MakeSlot && make)
+  {
+    if (2 * (m_size + 1) > m_ctrl.size()) rehash(std::max<size_t>(16, 2 * m_ctrl.size()));
+    std::uint64_t const h = hash(key);
+    auto const [i, found] = find_slot(key, h);
+    if (!found)
+    {
+      m_ctrl[i] = tag(h);
+      m_slots[i] = make();
+      ++m_size;
+    }
+    return { &m_slots[i], !found };
+  }
+
+  [[nodiscard]]
+  Slot const * find(Key const & key) const
+  {
+    if (m_size == 0) return nullptr;
+    auto const [i, found] = find_slot(key, hash(key));
+    return found ? &m_slots[i] : nullptr;
+  }
+
+  [[nodiscard]]
+  size_t size() const
+  {
+    return m_size;
+  }
+
+  [[nodiscard]]
+  size_t capacity() const
+  {
+    return m_ctrl.size();
+  }
+
+  /**
+   * @brief Number of bytes held by the table storage.
+   */
+  [[nodiscard]]
+  size_t memory_usage() const
+  {
+    return m_ctrl.capacity() * sizeof(std::uint8_t) + m_slots.capacity() * sizeof(Slot);
+  }
+
+private:
+
+  std::uint64_t hash(Key const & key) const
+  {
+    return mix(m_hash(key));
+  }
+
+  /**
+   * @brief Locate either the slot holding @p key or the empty slot where it belongs.
+   */
+  std::pair<size_t, bool> find_slot(Key const & key, std::uint64_t const h) const
+  {
+    std::uint8_t const t = tag(h);
+    size_t const mask = m_ctrl.size() - 1;
+    for (size_t i = h & mask; ; i = (i + 1) & mask)
+    {
+      if (m_ctrl[i] == 0) return { i, false };
+      if (m_ctrl[i] == t && m_equal(KeyOf{}(m_slots[i]), key)) return { i, true };
+    }
+  }
+
+  void rehash(size_t cap)
+  {
+    std::vector<std::uint8_t> ctrl(cap, 0);
+    std::vector<Slot> slots(cap);
+    std::swap(ctrl, m_ctrl);
+    std::swap(slots, m_slots);
+    for (size_t i = 0; i < ctrl.size(); ++i)
+    {
+      if (ctrl[i] == 0) continue;
+      Key const & key = KeyOf{}(slots[i]);
+      size_t const j = find_slot(key, hash(key)).first;
+      m_ctrl[j] = ctrl[i];
+      m_slots[j] = std::move(slots[i]);
+    }
+  }
+
+  std::vector<std::uint8_t> m_ctrl;
+  std::vector<Slot> m_slots;
+  size_t m_size{};
+  Hash m_hash{};
+  KeyEqual m_equal{};
+};
+
+} // namespace hashing
+
+/**
+ * @brief Open-addressing hash set with linear probing (see hashing::FlatTable).
+ *
+ * Values are stored inline, so lookups touch one array of control bytes and one of values.
+ * Supports only insertion and lookup (no erase), which is all that's needed for de-duplication.
+ * Interface follows std::unordered_set where it overlaps, so the two are interchangeable.
+ */
+template <typename T, typename Hash = std::hash<T>, typename KeyEqual = std::equal_to<T>>
+class FlatHashSet
+{
+public:
+
+  FlatHashSet() = default;
+
+  explicit FlatHashSet(size_t expected_size)
+  {
+    reserve(expected_size);
+  }
+
+  /**
+   * @brief Make room for @p n values without rehashing.
+   */
+  void reserve(size_t n)
+  {
+    m_table.reserve(n);
+  }
+
+  /**
+   * @brief Insert a value unless already present, probing the table once.
+   * @return pointer to the stored value and whether insertion took place
+   */
+  std::pair<T const *, bool> insert(T const & val)
+  {
+    auto const [slot, inserted] = m_table.emplace(val, [&] { return val; });
+    return { slot, inserted };
+  }
+
+  [[nodiscard]]
+  size_t count(T const & val) const
+  {
+    return m_table.find(val) ? 1 : 0;
+  }
+
+  [[nodiscard]]
+  bool contains(T const & val) const
+  {
+    return count(val) > 0;
+  }
+
+  [[nodiscard]]
+  size_t size() const
+  {
+    return m_table.size();
+  }
+
+  [[nodiscard]]
+  bool empty() const
+  {
+    return size() == 0;
+  }
+
+  [[nodiscard]]
+  size_t capacity() const
+  {
+    return m_table.capacity();
+  }
+
+  /**
+   * @brief Number of bytes held by the table storage.
+   */
+  [[nodiscard]]
+  size_t memory_usage() const
+  {
+    return m_table.memory_usage();
+  }
+
+private:
+
+  hashing::FlatTable<T, T, hashing::Identity, Hash, KeyEqual> m_table;
+};
+
+/**
+ * @brief Open-addressing hash map with linear probing (see hashing::FlatTable).
+ *
+ * Key/value pairs are stored inline; no erase. Intended for small keys such as pointers.
+ */
+template <typename K, typename V, typename Hash = std::hash<K>, typename KeyEqual = std::equal_to<K>>
+class FlatHashMap
+{
+public:
+
+  FlatHashMap() = default;
+
+  explicit FlatHashMap(size_t expected_size)
+  {
+    m_table.reserve(expected_size);
+  }
+
+  /**
+   * @brief Insert (key, val) unless the key is already present, probing the table once.
+   * @return pointer to the mapped value and whether insertion took place
+   */
+  std::pair<V *, bool> try_emplace(K const & key, V val = V{})
+  {
+    auto const [slot, inserted] = m_table.emplace(key, [&] { return std::pair<K, V>(key, std::move(val)); });
+    return { &slot->second, inserted };
+  }
+
+  [[nodiscard]]
+  V const * find(K const & key) const
+  {
+    auto const * slot = m_table.find(key);
+    return slot ? &slot->second : nullptr;
+  }
+
+  [[nodiscard]]
+  size_t size() const
+  {
+    return m_table.size();
+  }
+
+  [[nodiscard]]
+  bool empty() const
+  {
+    return size() == 0;
+  }
+
+private:
+
+  hashing::FlatTable<std::pair<K, V>, K, hashing::First, Hash, KeyEqual> m_table;
+};
+
+/**
+ * @brief Bloom filter over values of type T.
+ *
+ * Answers "definitely not seen" or "possibly seen" using a fixed bit array
+ * and k probe positions derived from one 64-bit hash (double hashing).
+ */
+template <typename T, typename Hash = std::hash<T>>
+class BloomFilter
+{
+public:
+
+  /**
+   * @param expected_size number of values that will be inserted
+   * @param bits_per_value filter size per value; 10 bits gives about 1% false positives
+   */
+  explicit BloomFilter(size_t expected_size, size_t bits_per_value = 10)
+  : m_words(hashing::next_pow2(std::max<size_t>(64, expected_size * bits_per_value)) / 64, 0),
+    m_num_probes(std::max<size_t>(1, bits_per_value * 7 / 10))
+  {}
+
+  /**
+   * @brief Insert a value.
+   * @return true if the value was possibly inserted before, false if definitely not
+   */
+  bool insert(T const & val)
+  {
+    bool seen = true;
+    for_each_probe(val, [&](std::uint64_t const b)
+    {
+      std::uint64_t const bit = std::uint64_t{1} << (b % 64);
+      seen = seen && (m_words[b / 64] & bit);
+      m_words[b / 64] |= bit;
+    });
+    return seen;
+  }
+
+  [[nodiscard]]
+  bool possibly_contains(T const & val) const
+  {
+    bool seen = true;
+    for_each_probe(val, [&](std::uint64_t const b)
+    {
+      seen = seen && (m_words[b / 64] & (std::uint64_t{1} << (b % 64)));
+    });
+    return seen;
+  }
+
+  [[nodiscard]]
+  size_t memory_usage() const
+  {
+    return m_words.capacity() * sizeof(std::uint64_t);
+  }
+
+private:
+
+  template <typename F>
+  void for_each_probe(T const & val, F && f) const
+  {
+    std::uint64_t const h = hashing::mix(m_hash(val));
+    std::uint64_t const h1 = h;
+    std::uint64_t const h2 = (h >> 32) | (h << 32) | 1;
+    std::uint64_t const mask = m_words.size() * 64 - 1;
+    for (size_t i = 0; i < m_num_probes; ++i)
+    {
+      f((h1 + i * h2) & mask);
+    }
+  }
+
+  std::vector<std::uint64_t> m_words;
+  size_t m_num_probes;
+  Hash m_hash{};
+};
+
+#endif //CTCI_SOLUTIONS_HASHING_HPP
@@ -0,0 +1,208 @@
+#ifndef CTCI_SOLUTIONS_POOLLIST_HPP
+#define CTCI_SOLUTIONS_POOLLIST_HPP
+
+#include <initializer_list>
+#include <ostream>
+#include <vector>
+#include <limits>
+#include <utility>
+#include <cassert>
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * @brief Doubly-linked list with pooled, index-linked nodes
+ *
+ * Nodes live in contiguous arrays (structure-of-arrays: one array of values,
+ * one of next links, one of prev links) and refer to each other by 32-bit indices,
+ * so a link costs 4 bytes instead of 8 and walking links never leaves the pool.
+ * Removed slots are chained into a free list (through the next array) and reused.
+ * After many insertions/removals traversal order diverges from storage order;
+ * compact() restores locality by renumbering nodes in traversal order.
+ * Node indices are stable across all operations except compact().
+ * Like List, the structure is public and kept simple.
+ */
+template <typename T>
+struct PoolList
+{
+  using index_type = std::uint32_t;
+  static constexpr index_type npos = std::numeric_limits<index_type>::max();
+
+  std::vector<T> vals;
+  std::vector<index_type> next;
+  std::vector<index_type> prev;
+
+  index_type head = npos;
+  index_type tail = npos;
+  index_type free_head = npos;
+  size_t length = 0;
+
+  PoolList() = default;
+
+  PoolList(std::initializer_list<T> const & in)
+  {
+    reserve(in.size());
+    for (auto const & v : in) add_tail(v);
+  }
+
+  bool operator==(PoolList const & other) const
+  {
+    if (length != other.length) return false;
+    for (index_type l = head, r = other.head; l != npos; l = next[l], r = other.next[r])
+    {
+      if (vals[l] != other.vals[r]) return false;
+    }
+    return true;
+  }
+
+  [[nodiscard]] bool empty() const { return length == 0; }
+  [[nodiscard]] size_t size() const { return length; }
+
+  void reserve(size_t n)
+  {
+    vals.reserve(n);
+    next.reserve(n);
+    prev.reserve(n);
+  }
+
+  index_type add_head(T val)
+  {
+    index_type const i = alloc(std::move(val));
+    link_before(head, i, i);
+    return i;
+  }
+
+  index_type add_tail(T val)
+  {
+    index_type const i = alloc(std::move(val));
+    link_before(npos, i, i);
+    return i;
+  }
+
+  /**
+   * @brief Insert a value before node @p pos (or at the tail if @p pos is npos).
+   */
+  index_type insert(index_type pos, T val)
+  {
+    index_type const i = alloc(std::move(val));
+    link_before(pos, i, i);
+    return i;
+  }
+
+  void rem_head()
+  {
+    assert(head != npos);
+    rem(head);
+  }
+
+  void rem_tail()
+  {
+    assert(tail != npos);
+    rem(tail);
+  }
+
+  void rem(index_type i)
+  {
+    unlink(i, i);
+    vals[i] = T{};
+    next[i] = free_head;
+    free_head = i;
+    --length;
+  }
+
+  /**
+   * @brief Move the chain of nodes [first, last] (inclusive) of this list to just before @p pos.
+   *
+   * @p pos may be npos to move the chain to the tail; it must not be inside the chain.
+   * Time complexity: O(1).
+   */
+  void splice(index_type pos, index_type first, index_type last)
+  {
+    if (first == pos || next[last] == pos) return;
+    unlink(first, last);
+    link_before(pos, first, last);
+  }
+
+  /**
+   * @brief Renumber nodes in traversal order and release free slots.
+   *
+   * Afterwards node k of the traversal has index k, so walking the list
+   * is a sequential scan of each array. Invalidates all node indices.
+   */
+  void compact()
+  {
+    std::vector<T> new_vals;
+    new_vals.reserve(length);
+    for (index_type i = head; i != npos; i = next[i])
+    {
+      new_vals.push_back(std::move(vals[i]));
+    }
+    vals = std::move(new_vals);
+    index_type const n = static_cast<index_type>(length);
+    next.resize(n);
+    prev.resize(n);
+    next.shrink_to_fit();
+    prev.shrink_to_fit();
+    for (index_type i = 0; i < n; ++i)
+    {
+      next[i] = i + 1 < n ? i + 1 : npos;
+      prev[i] = i > 0 ? i - 1 : npos;
+    }
+    head = n > 0 ? 0 : npos;
+    tail = n > 0 ? n - 1 : npos;
+    free_head = npos;
+  }
+
+  friend std::ostream & operator<<(std::ostream & os, PoolList<T> const & l)
+  {
+    os << "head -> ";
+    for (index_type i = l.head; i != npos; i = l.next[i])
+    {
+      os << l.vals[i] << (i == l.tail ? "" : " <-> ");
+    }
+    os << " <- tail";
+    return os;
+  }
+
+  ////////////////////////////////////////////////////////////////////////////////
+
+private:
+
+  index_type alloc(T val)
+  {
+    ++length;
+    if (free_head != npos)
+    {
+      index_type const i = free_head;
+      free_head = next[i];
+      vals[i] = std::move(val);
+      return i;
+    }
+    assert(vals.size() < npos);
+    vals.push_back(std::move(val));
+    next.push_back(npos);
+    prev.push_back(npos);
+    return static_cast<index_type>(vals.size() - 1);
+  }
+
+  void unlink(index_type first, index_type last)
+  {
+    if (prev[first] != npos) next[prev[first]] = next[last];
+    else head = next[last];
+    if (next[last] != npos) prev[next[last]] = prev[first];
+    else tail = prev[first];
+  }
+
+  void link_before(index_type pos, index_type first, index_type last)
+  {
+    index_type const before = pos != npos ? prev[pos] : tail;
+    prev[first] = before;
+    next[last] = pos;
+    if (before != npos) next[before] = first;
+    else head = first;
+    if (pos != npos) prev[pos] = last;
+    else tail = last;
+  }
+};
+
+#endif //CTCI_SOLUTIONS_POOLLIST_HPP
@@ -0,0 +1,141 @@
+#ifndef CTCI_SOLUTIONS_RINGQUEUE_HPP
+#define CTCI_SOLUTIONS_RINGQUEUE_HPP
+
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+
+/**
+ * @brief FIFO queue over a growable ring buffer
+ *
+ * Values live in one contiguous array whose capacity is a power of two, so wrapping
+ * an index is a mask rather than a division. When full, the buffer doubles and the values
+ * are moved over in queue order; it never shrinks. Interface follows std::queue, and add/remove/peek
+ * mirror MyQueue (ch3/p4), so either can be swapped in for the other.
+ * T must be default-constructible and move-assignable.
+ */
+template <typename T>
+class RingQueue
+{
+public:
+
+  RingQueue() = default;
+
+  explicit RingQueue(size_t capacity)
+  {
+    reserve(capacity);
+  }
+
+  /**
+   * @brief Make room for @p n values without further reallocation.
+   */
+  void reserve(size_t n)
+  {
+    if (n <= m_buf.size()) return;
+    size_t cap = 1;
+    while (cap < n) cap <<= 1;
+    std::vector<T> buf(cap);
+    for (size_t i = 0; i < m_size; ++i) buf[i] = std::move((*this)[i]);
+    m_buf = std::move(buf);
+    m_head = 0;
+  }
+
+  void push(T val)
+  {
+    if (m_size == m_buf.size()) reserve(std::max<size_t>(16, 2 * m_buf.size()));
+    m_buf[(m_head + m_size++) & (m_buf.size() - 1)] = std::move(val);
+  }
+
+  void pop()
+  {
+    assert(!empty());
+    m_buf[m_head] = T{};
+    m_head = (m_head + 1) & (m_buf.size() - 1);
+    --m_size;
+  }
+
+  void add(T val)
+  {
+    push(std::move(val));
+  }
+
+  void remove()
+  {
+    pop();
+  }
+
+  [[nodiscard]]
+  T const & peek() const
+  {
+    return front();
+  }
+
+  [[nodiscard]]
+  T & front()
+  {
+    assert(!empty());
+    return m_buf[m_head];
+  }
+
+  [[nodiscard]]
+  T const & front() const
+  {
+    assert(!empty());
+    return m_buf[m_head];
+  }
+
+  [[nodiscard]]
+  T & back()
+  {
+    assert(!empty());
+    return (*this)[m_size - 1];
+  }
+
+  [[nodiscard]]
+  T const & back() const
+  {
+    assert(!empty());
+    return (*this)[m_size - 1];
+  }
+
+  /**
+   * @brief Value at position @p i counted from the front.
+   */
+  T & operator[](size_t i)
+  {
+    return m_buf[(m_head + i) & (m_buf.size() - 1)];
+  }
+
+  T const & operator[](size_t i) const
+  {
+    return m_buf[(m_head + i) & (m_buf.size() - 1)];
+  }
+
+  [[nodiscard]]
+  bool empty() const
+  {
+    return m_size == 0;
+  }
+
+  [[nodiscard]]
+  size_t size() const
+  {
+    return m_size;
+  }
+
+  [[nodiscard]]
+  size_t capacity() const
+  {
+    return m_buf.size();
+  }
+
+private:
+
+  std::vector<T> m_buf;
+  size_t m_head{};
+  size_t m_size{};
+};
+
+#endif //CTCI_SOLUTIONS_RINGQUEUE_HPP
@@ -0,0 +1,283 @@
+#ifndef CTCI_SOLUTIONS_SPILLSTACK_HPP
+#define CTCI_SOLUTIONS_SPILLSTACK_HPP
+
+#include <deque>
+#include <vector>
+#include <optional>
+#include <string>
+#include <utility>
+#include <algorithm>
+#include <type_traits>
+#include <system_error>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <cassert>
+#include <cstddef>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+/**
+ * Helpers for data structures that keep part of their contents on disk (POSIX only).
+ */
+namespace spill
+{
+  /**
+   * @brief Anonymous temporary file: created in $TMPDIR (or /tmp) and unlinked right away,
+   *        so it disappears when closed. I/O errors are reported as std::system_error.
+   */
+  class TempFile
+  {
+  public:
+
+    TempFile()
+    {
+      char const * dir = std::getenv("TMPDIR");
+      std::string path = std::string(dir && *dir ? dir : "/tmp") + "/ctci-spill-XXXXXX";
+      m_fd = ::mkstemp(path.data());
+      if (m_fd < 0) throw std::system_error(errno, std::generic_category(), "mkstemp");
+      ::unlink(path.c_str());
+    }
+
+    TempFile(TempFile && other) noexcept : m_fd(std::exchange(other.m_fd, -1)) {}
+
+    TempFile & operator=(TempFile && other) noexcept
+    {
+      std::swap(m_fd, other.m_fd);
+      return *this;
+    }
+
+    ~TempFile()
+    {
+      if (m_fd >= 0) ::close(m_fd);
+    }
+
+    void write_at(size_t offset, void const * data, size_t bytes)
+    {
+      auto const * p = static_cast<char const *>(data);
+      while (bytes > 0)
+      {
+        ssize_t const n = ::pwrite(m_fd, p, bytes, static_cast<off_t>(offset));
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) throw std::system_error(errno, std::generic_category(), "pwrite");
+        p += n;
+        offset += static_cast<size_t>(n);
+        bytes -= static_cast<size_t>(n);
+      }
+    }
+
+    void read_at(size_t offset, void * data, size_t bytes) const
+    {
+      auto * p = static_cast<char *>(data);
+      while (bytes > 0)
+      {
+        ssize_t const n = ::pread(m_fd, p, bytes, static_cast<off_t>(offset));
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) throw std::system_error(n < 0 ? errno : EIO, std::generic_category(), "pread");
+        p += n;
+        offset += static_cast<size_t>(n);
+        bytes -= static_cast<size_t>(n);
+      }
+    }
+
+    /**
+     * @brief Grow (or shrink) the file to @p bytes.
+     */
+    void resize(size_t bytes)
+    {
+      if (::ftruncate(m_fd, static_cast<off_t>(bytes)) != 0)
+      {
+        throw std::system_error(errno, std::generic_category(), "ftruncate");
+      }
+    }
+
+    [[nodiscard]]
+    int fd() const
+    {
+      return m_fd;
+    }
+
+  private:
+
+    int m_fd = -1;
+  };
+
+  /**
+   * @brief Read-write shared mapping of a byte range of a file, unmapped on destruction.
+   */
+  class Mapping
+  {
+  public:
+
+    Mapping(int fd, size_t offset, size_t bytes)
+    {
+      static size_t const page = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+      size_t const aligned = offset / page * page;
+      m_len = bytes + (offset - aligned);
+      m_base = ::mmap(nullptr, m_len, PROT_READ | PROT_WRITE, MAP_SHARED, fd, static_cast<off_t>(aligned));
+      if (m_base == MAP_FAILED) throw std::system_error(errno, std::generic_category(), "mmap");
+      m_data = static_cast<char *>(m_base) + (offset - aligned);
+    }
+
+    Mapping(Mapping const &) = delete;
+    Mapping & operator=(Mapping const &) = delete;
+
+    ~Mapping()
+    {
+      ::munmap(m_base, m_len);
+    }
+
+    [[nodiscard]]
+    void * data() const
+    {
+      return m_data;
+    }
+
+  private:
+
+    void * m_base;
+    void * m_data;
+    size_t m_len;
+  };
+}
+
+/**
+ * @brief Stack that keeps only its top segments in memory and spills the rest to a file
+ *
+ * Values are grouped in fixed-size segments. At most max_resident segments stay in memory;
+ * when another one is needed, the bottom-most resident segment is copied through a memory mapping
+ * into a temporary file, where spilled segments are laid out bottom-up. The file is created on the first spill. Popping past the last
+ * resident segment maps the topmost spilled one back. Because the file is only touched a segment
+ * at a time and a full segment must be popped before one is reloaded, alternating pushes and pops
+ * near a segment boundary do not thrash.
+ * Interface follows std::stack. T must be trivially copyable (it is stored as raw bytes).
+ */
+template <typename T>
+class SpillStack
+{
+  static_assert(std::is_trivially_copyable_v<T>, "SpillStack stores values as raw bytes");
+
+public:
+
+  /**
+   * @param segment_bytes size of a segment (rounded down to a whole number of values, at least one)
+   * @param max_resident number of segments kept in memory, at least 2
+   */
+  explicit SpillStack(size_t segment_bytes = size_t{1} << 20, size_t max_resident = 4)
+  : m_segment_size(std::max<size_t>(1, segment_bytes / sizeof(T))),
+    m_max_resident(std::max<size_t>(2, max_resident))
+  {}
+
+  void push(T const & val)
+  {
+    if (m_resident.empty() || m_resident.back().size() == m_segment_size) add_segment();
+    m_resident.back().push_back(val);
+  }
+
+  template <typename... Args>
+  void emplace(Args &&... args)
+  {
+    push(T(std::forward<Args>(args)...));
+  }
+
+  void pop()
+  {
+    assert(!empty());
+    m_resident.back().pop_back();
+    if (m_resident.back().empty())
+    {
+      m_spare = std::move(m_resident.back());
+      m_resident.pop_back();
+      if (m_resident.empty() && m_spilled > 0) reload();
+    }
+  }
+
+  [[nodiscard]]
+  T const & top() const
+  {
+    assert(!empty());
+    return m_resident.back().back();
+  }
+
+  [[nodiscard]]
+  bool empty() const
+  {
+    return m_resident.empty();
+  }
+
+  [[nodiscard]]
+  size_t size() const
+  {
+    size_t n = m_spilled * m_segment_size;
+    for (auto const & seg : m_resident) n += seg.size();
+    return n;
+  }
+
+  /**
+   * @brief Number of values currently held on disk.
+   */
+  [[nodiscard]]
+  size_t spilled() const
+  {
+    return m_spilled * m_segment_size;
+  }
+
+private:
+
+  size_t segment_bytes() const
+  {
+    return m_segment_size * sizeof(T);
+  }
+
+  std::vector<T> take_buffer()
+  {
+    std::vector<T> buf = std::move(m_spare);
+    buf.clear();
+    buf.reserve(m_segment_size);
+    return buf;
+  }
+
+  void add_segment()
+  {
+    if (m_resident.size() == m_max_resident)
+    {
+      // spill the bottom resident segment (always full) right above the already spilled ones
+      std::vector<T> & bottom = m_resident.front();
+      size_t const offset = m_spilled * segment_bytes();
+      if (!m_file) m_file.emplace();
+      if (m_file_size < offset + segment_bytes())
+      {
+        m_file_size = std::max(offset + segment_bytes(), 2 * m_file_size);
+        m_file->resize(m_file_size);
+      }
+      spill::Mapping map(m_file->fd(), offset, segment_bytes());
+      std::memcpy(map.data(), bottom.data(), segment_bytes());
+      ++m_spilled;
+      m_spare = std::move(bottom);
+      m_resident.pop_front();
+    }
+    m_resident.push_back(take_buffer());
+  }
+
+  void reload()
+  {
+    --m_spilled;
+    std::vector<T> buf = take_buffer();
+    buf.resize(m_segment_size);
+    spill::Mapping map(m_file->fd(), m_spilled * segment_bytes(), segment_bytes());
+    std::memcpy(buf.data(), map.data(), segment_bytes());
+    m_resident.push_back(std::move(buf));
+  }
+
+  size_t m_segment_size;
+  size_t m_max_resident;
+  std::deque<std::vector<T>> m_resident;
+  std::vector<T> m_spare;
+  size_t m_spilled{};
+  size_t m_file_size{};
+  std::optional<spill::TempFile> m_file;
+};
+
+#endif //CTCI_SOLUTIONS_SPILLSTACK_HPP
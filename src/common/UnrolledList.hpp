@@ -0,0 +1,289 @@
+#ifndef CTCI_SOLUTIONS_UNROLLEDLIST_HPP
+#define CTCI_SOLUTIONS_UNROLLEDLIST_HPP
+
+#include <initializer_list>
+#include <ostream>
+#include <iterator>
+#include <utility>
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstddef>
+
+namespace unrolled
+{
+  inline constexpr size_t cache_line_size = 64;
+
+  /**
+   * @brief Number of values per node so that a node fills about two cache lines
+   *        (but no fewer than 4 values per node for large T).
+   */
+  template <typename T>
+  constexpr size_t node_capacity()
+  {
+    constexpr size_t header = 2 * sizeof(void *) + sizeof(size_t);
+    constexpr size_t fit = (2 * cache_line_size - header) / sizeof(T);
+    return fit < 4 ? 4 : fit;
+  }
+}
+
+/**
+ * @brief Unrolled linked list
+ *
+ * A list of nodes each holding up to K values in a contiguous array, so sequential
+ * traversal touches one node (about two cache lines) per K values instead of one per value.
+ * Nodes are doubly-linked, which makes removal of emptied nodes and reverse walks cheap.
+ * Insertion into a full node splits it in half; removal that leaves a node less than
+ * half full either merges it with the next node or borrows values from it.
+ * Like FwdList, the structure is public and kept simple.
+ */
+template <typename T, size_t K = unrolled::node_capacity<T>()>
+struct UnrolledList
+{
+  static_assert(K >= 2, "node capacity must be at least 2");
+
+  struct Node
+  {
+    Node * prev{};
+    Node * next{};
+    size_t count{};
+    std::array<T, K> vals{};
+  };
+
+  template <bool Const>
+  class Iterator
+  {
+  public:
+
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = T;
+    using difference_type = std::ptrdiff_t;
+    using pointer = std::conditional_t<Const, T const *, T *>;
+    using reference = std::conditional_t<Const, T const &, T &>;
+
+    Iterator() = default;
+    Iterator(Node * n, size_t i) : node(n), idx(i) {}
+
+    // allow conversion from iterator to const_iterator
+    template <bool C = Const, typename = std::enable_if_t<C>>
+    Iterator(Iterator<false> const & other) : node(other.node), idx(other.idx) {}
+
+    reference operator*() const { return node->vals[idx]; }
+    pointer operator->() const { return &node->vals[idx]; }
+
+    Iterator & operator++()
+    {
+      if (++idx == node->count)
+      {
+        node = node->next;
+        idx = 0;
+      }
+      return *this;
+    }
+
+    Iterator operator++(int)
+    {
+      Iterator tmp = *this;
+      ++*this;
+      return tmp;
+    }
+
+    friend bool operator==(Iterator const & a, Iterator const & b) { return a.node == b.node && a.idx == b.idx; }
+    friend bool operator!=(Iterator const & a, Iterator const & b) { return !(a == b); }
+
+    Node * node{};
+    size_t idx{};
+  };
+
+  using iterator = Iterator<false>;
+  using const_iterator = Iterator<true>;
+
+  Node * head{};
+  Node * tail{};
+  size_t length{};
+
+  UnrolledList() = default;
+
+  UnrolledList(std::initializer_list<T> const & in)
+  {
+    for (auto const & v : in) push_back(v);
+  }
+
+  UnrolledList(UnrolledList const & other)
+  {
+    if (this == &other) return;
+    for (Node * n = other.head; n; n = n->next)
+    {
+      Node * const curr = append_node();
+      curr->vals = n->vals;
+      curr->count = n->count;
+    }
+    length = other.length;
+  }
+
+  UnrolledList(UnrolledList && other)
+  {
+    std::swap(head, other.head);
+    std::swap(tail, other.tail);
+    std::swap(length, other.length);
+  }
+
+  ~UnrolledList()
+  {
+    clear();
+  }
+
+  bool operator==(UnrolledList const & other) const
+  {
+    return length == other.length && std::equal(begin(), end(), other.begin());
+  }
+
+  [[nodiscard]] bool empty() const { return length == 0; }
+  [[nodiscard]] size_t size() const { return length; }
+
+  iterator begin() { return { head, 0 }; }
+  iterator end() { return {}; }
+  const_iterator begin() const { return { head, 0 }; }
+  const_iterator end() const { return {}; }
+
+  void clear()
+  {
+    while (head)
+    {
+      Node * curr = head;
+      head = curr->next;
+      delete curr;
+    }
+    tail = nullptr;
+    length = 0;
+  }
+
+  void push_back(T val)
+  {
+    if (!tail || tail->count == K) append_node();
+    tail->vals[tail->count++] = std::move(val);
+    ++length;
+  }
+
+  void push_front(T val)
+  {
+    insert(begin(), std::move(val));
+  }
+
+  /**
+   * @brief Insert a value before @p pos, splitting the node if it is full.
+   * @return iterator to the inserted value
+   */
+  iterator insert(const_iterator pos, T val)
+  {
+    if (!pos.node)
+    {
+      push_back(std::move(val));
+      return { tail, tail->count - 1 };
+    }
+    Node * node = pos.node;
+    size_t idx = pos.idx;
+    if (node->count == K)
+    {
+      Node * const right = split(node);
+      if (idx > node->count)
+      {
+        idx -= node->count;
+        node = right;
+      }
+    }
+    std::move_backward(node->vals.begin() + idx, node->vals.begin() + node->count, node->vals.begin() + node->count + 1);
+    node->vals[idx] = std::move(val);
+    ++node->count;
+    ++length;
+    return { node, idx };
+  }
+
+  /**
+   * @brief Remove the value at @p pos, merging or rebalancing an underfull node with its successor.
+   * @return iterator to the value that followed the removed one
+   */
+  iterator erase(const_iterator pos)
+  {
+    assert(pos.node);
+    Node * const node = pos.node;
+    size_t const idx = pos.idx;
+    std::move(node->vals.begin() + idx + 1, node->vals.begin() + node->count, node->vals.begin() + idx);
+    --node->count;
+    --length;
+
+    if (node->count < K / 2 && node->next)
+    {
+      Node * const next = node->next;
+      size_t const total = node->count + next->count;
+      size_t const take = total <= K ? next->count : total / 2 - node->count;
+      std::move(next->vals.begin(), next->vals.begin() + take, node->vals.begin() + node->count);
+      std::move(next->vals.begin() + take, next->vals.begin() + next->count, next->vals.begin());
+      node->count += take;
+      next->count -= take;
+      if (next->count == 0) unlink(next);
+    }
+
+    if (node->count == 0)
+    {
+      unlink(node);
+      return end();
+    }
+    if (idx < node->count) return { node, idx };
+    return { node->next, 0 };
+  }
+
+  friend std::ostream & operator<<(std::ostream & os, UnrolledList const & l)
+  {
+    os << "head -> ";
+    for (auto const & v : l)
+    {
+      os << v << " <-> ";
+    }
+    os << "null";
+    return os;
+  }
+
+  ////////////////////////////////////////////////////////////////////////////////
+
+private:
+
+  Node * append_node()
+  {
+    Node * const node = new Node();
+    node->prev = tail;
+    if (tail) tail->next = node;
+    else head = node;
+    tail = node;
+    return node;
+  }
+
+  /**
+   * @brief Move upper half of a full node into a new node inserted right after it.
+   */
+  Node * split(Node * const node)
+  {
+    Node * const right = new Node();
+    size_t const keep = node->count / 2;
+    std::move(node->vals.begin() + keep, node->vals.begin() + node->count, right->vals.begin());
+    right->count = node->count - keep;
+    node->count = keep;
+    right->prev = node;
+    right->next = node->next;
+    if (node->next) node->next->prev = right;
+    else tail = right;
+    node->next = right;
+    return right;
+  }
+
+  void unlink(Node * const node)
+  {
+    if (node->prev) node->prev->next = node->next;
+    else head = node->next;
+    if (node->next) node->next->prev = node->prev;
+    else tail = node->prev;
+    delete node;
+  }
+};
+
+#endif //CTCI_SOLUTIONS_UNROLLEDLIST_HPP
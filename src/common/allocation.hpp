@@ -0,0 +1,116 @@
+#ifndef CTCI_SOLUTIONS_ALLOCATION_HPP
+#define CTCI_SOLUTIONS_ALLOCATION_HPP
+
+#include <atomic>
+#include <new>
+#include <cstdlib>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * Heap usage accounting for benchmarks.
+ *
+ * Including this header replaces global operator new/delete in the executable
+ * with versions that track current and peak number of bytes allocated.
+ * Each problem is a separate executable, so include it at most once per program.
+ */
+namespace allocation
+{
+  inline std::atomic<size_t> current_bytes{0};
+  inline std::atomic<size_t> peak_bytes{0};
+  inline std::atomic<size_t> num_allocations{0};
+
+  // keeps returned pointers aligned for any fundamental type
+  inline constexpr size_t header_size = alignof(std::max_align_t);
+
+  // stored right before every returned pointer
+  struct Header
+  {
+    size_t size;
+    void * raw;
+  };
+
+  /**
+   * @brief Allocate @p n bytes aligned to @p align (at least fundamental alignment).
+   */
+  inline void * allocate(size_t n, size_t align = header_size)
+  {
+    align = align < header_size ? header_size : align;
+    void * const raw = std::malloc(n + sizeof(Header) + align);
+    if (!raw) throw std::bad_alloc{};
+    auto const addr = reinterpret_cast<std::uintptr_t>(raw) + sizeof(Header);
+    void * const p = reinterpret_cast<void *>((addr + align - 1) / align * align);
+    static_cast<Header *>(p)[-1] = Header{ n, raw };
+    size_t const curr = current_bytes += n;
+    ++num_allocations;
+    size_t peak = peak_bytes.load(std::memory_order_relaxed);
+    while (curr > peak && !peak_bytes.compare_exchange_weak(peak, curr, std::memory_order_relaxed));
+    return p;
+  }
+
+  inline void * allocate_nothrow(size_t n, size_t align = header_size) noexcept
+  {
+    try
+    {
+      return allocate(n, align);
+    }
+    catch (std::bad_alloc const &)
+    {
+      return nullptr;
+    }
+  }
+
+  // GCC can't see that every pointer reaching here came from allocate() above
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+  inline void deallocate(void * ptr) noexcept
+  {
+    if (!ptr) return;
+    Header const h = static_cast<Header *>(ptr)[-1];
+    current_bytes -= h.size;
+    std::free(h.raw);
+  }
+#pragma GCC diagnostic pop
+
+  /**
+   * @brief Peak number of bytes allocated on top of what was live before calling f().
+   */
+  template <typename F>
+  size_t peak_usage(F && f)
+  {
+    size_t const base = current_bytes.load();
+    peak_bytes = base;
+    f();
+    return peak_bytes.load() - base;
+  }
+}
+
+// every replaceable form, so that no memory from the default allocator reaches deallocate()
+void * operator new(size_t n) { return allocation::allocate(n); }
+void * operator new[](size_t n) { return allocation::allocate(n); }
+void * operator new(size_t n, std::nothrow_t const &) noexcept { return allocation::allocate_nothrow(n); }
+void * operator new[](size_t n, std::nothrow_t const &) noexcept { return allocation::allocate_nothrow(n); }
+void * operator new(size_t n, std::align_val_t a) { return allocation::allocate(n, static_cast<size_t>(a)); }
+void * operator new[](size_t n, std::align_val_t a) { return allocation::allocate(n, static_cast<size_t>(a)); }
+void * operator new(size_t n, std::align_val_t a, std::nothrow_t const &) noexcept
+{
+  return allocation::allocate_nothrow(n, static_cast<size_t>(a));
+}
+void * operator new[](size_t n, std::align_val_t a, std::nothrow_t const &) noexcept
+{
+  return allocation::allocate_nothrow(n, static_cast<size_t>(a));
+}
+void operator delete(void * p) noexcept { allocation::deallocate(p); }
+void operator delete[](void * p) noexcept { allocation::deallocate(p); }
+void operator delete(void * p, size_t) noexcept { allocation::deallocate(p); }
+void operator delete[](void * p, size_t) noexcept { allocation::deallocate(p); }
+void operator delete(void * p, std::nothrow_t const &) noexcept { allocation::deallocate(p); }
+void operator delete[](void * p, std::nothrow_t const &) noexcept { allocation::deallocate(p); }
+void operator delete(void * p, std::align_val_t) noexcept { allocation::deallocate(p); }
+void operator delete[](void * p, std::align_val_t) noexcept { allocation::deallocate(p); }
+void operator delete(void * p, size_t, std::align_val_t) noexcept { allocation::deallocate(p); }
+void operator delete[](void * p, size_t, std::align_val_t) noexcept { allocation::deallocate(p); }
+void operator delete(void * p, std::align_val_t, std::nothrow_t const &) noexcept { allocation::deallocate(p); }
+void operator delete[](void * p, std::align_val_t, std::nothrow_t const &) noexcept { allocation::deallocate(p); }
+
+#endif //CTCI_SOLUTIONS_ALLOCATION_HPP
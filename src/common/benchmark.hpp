@@ -0,0 +1,97 @@
+#ifndef CTCI_SOLUTIONS_BENCHMARK_HPP
+#define CTCI_SOLUTIONS_BENCHMARK_HPP
+
+#include <chrono>
+#include <iostream>
+#include <iomanip>
+#include <string_view>
+#include <limits>
+#include <algorithm>
+#include <cstddef>
+
+/**
+ * Minimal benchmarking helpers.
+ *
+ * Benchmarks live next to the tests in each problem's main() and only run
+ * when the executable is invoked with "--bench", so regular test runs stay fast.
+ * Build with optimization (e.g. -DCMAKE_BUILD_TYPE=Release) to get meaningful numbers.
+ */
+namespace benchmark
+{
+  inline bool requested(int argc, char ** argv)
+  {
+    return argc > 1 && std::string_view(argv[1]) == "--bench";
+  }
+
+  class Timer
+  {
+  public:
+
+    using clock = std::chrono::steady_clock;
+
+    Timer() : m_start(clock::now()) {}
+
+    [[nodiscard]]
+    double seconds() const
+    {
+      return std::chrono::duration<double>(clock::now() - m_start).count();
+    }
+
+  private:
+
+    clock::time_point m_start;
+  };
+
+  /**
+   * @brief Prevent the compiler from optimizing away a computed value.
+   */
+  template <typename T>
+  inline void do_not_optimize(T const & val)
+  {
+    asm volatile("" : : "r,m"(val) : "memory");
+  }
+
+  /**
+   * @brief Best-of-N wall time of f().
+   */
+  template <typename F>
+  double measure(F && f, int reps = 3)
+  {
+    double best = std::numeric_limits<double>::max();
+    for (int r = 0; r < reps; ++r)
+    {
+      Timer t;
+      f();
+      best = std::min(best, t.seconds());
+    }
+    return best;
+  }
+
+  /**
+   * @brief Best-of-N wall time of f(setup()), where the setup is not timed.
+   */
+  template <typename S, typename F>
+  double measure(S && setup, F && f, int reps)
+  {
+    double best = std::numeric_limits<double>::max();
+    for (int r = 0; r < reps; ++r)
+    {
+      auto state = setup();
+      Timer t;
+      f(state);
+      best = std::min(best, t.seconds());
+    }
+    return best;
+  }
+
+  inline void report(std::string_view name, size_t n, double seconds)
+  {
+    std::cout << std::left << std::setw(40) << name
+              << " n=" << std::setw(10) << n
+              << std::right << std::fixed << std::setprecision(3)
+              << std::setw(10) << seconds * 1e3 << " ms"
+              << std::setw(10) << (n > 0 ? seconds * 1e9 / n : 0.0) << " ns/elem\n";
+  }
+}
+
+#endif //CTCI_SOLUTIONS_BENCHMARK_HPP
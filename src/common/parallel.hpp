@@ -0,0 +1,39 @@
+#ifndef CTCI_SOLUTIONS_PARALLEL_HPP
+#define CTCI_SOLUTIONS_PARALLEL_HPP
+
+#include <thread>
+#include <vector>
+#include <algorithm>
+#include <cstddef>
+
+/**
+ * Bare-bones fork-join helpers on top of std::thread.
+ */
+namespace parallel
+{
+  inline unsigned default_threads()
+  {
+    return std::max(1u, std::thread::hardware_concurrency());
+  }
+
+  /**
+   * @brief Split [0, n) into @p num_threads contiguous chunks and call f(chunk, begin, end) on each.
+   *
+   * Chunk 0 runs on the calling thread, the rest on freshly spawned threads; returns after all finish.
+   */
+  template <typename F>
+  void for_chunks(size_t n, unsigned num_threads, F && f)
+  {
+    num_threads = static_cast<unsigned>(std::max<size_t>(1, std::min<size_t>(num_threads, n)));
+    std::vector<std::thread> threads;
+    threads.reserve(num_threads - 1);
+    for (unsigned t = 1; t < num_threads; ++t)
+    {
+      threads.emplace_back([&f, t, n, num_threads]{ f(t, n * t / num_threads, n * (t + 1) / num_threads); });
+    }
+    f(0u, size_t{0}, n / num_threads);
+    for (auto & th : threads) th.join();
+  }
+}
+
+#endif //CTCI_SOLUTIONS_PARALLEL_HPP
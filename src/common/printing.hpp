@@ -4,6 +4,8 @@
 #include <type_traits>
 #include <bitset>
 #include <cstddef>
+#include <limits>
+#include <string_view>
 
 #ifndef CTCI_SOLUTIONS_PRINTING_HPP
 #define CTCI_SOLUTIONS_PRINTING_HPP
@@ -67,7 +69,8 @@ std::ostream & operator<<(std::ostream & os, std::tuple<Ts...> const & t)
  * @return the stream @p os
  */
 template<typename R, // below is VERY simplified SFINAE check for a range-like type (only allows common ranges, actually)
-         typename = std::enable_if_t<std::is_same_v<decltype(std::cbegin(std::declval<R>())), decltype(std::cend(std::declval<R>()))> && !std::is_array_v<R>>>
+         typename = std::enable_if_t<std::is_same_v<decltype(std::cbegin(std::declval<R>())), decltype(std::cend(std::declval<R>()))> && !std::is_array_v<R>
+                                             && !std::is_convertible_v<R const &, std::string_view>>>
 std::ostream & operator<<(std::ostream & os, R const & rng)
 {
   auto it = std::cbegin(rng);